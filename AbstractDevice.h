@@ -3,6 +3,7 @@
 #include <openvr_driver.h>
 #include "driverlog.h"
 #include "util.h"
+#include "AnchorCache.h"
 
 
 class AbstractDevice : public vr::ITrackedDeviceServerDriver {
@@ -21,7 +22,7 @@ class AbstractDevice : public vr::ITrackedDeviceServerDriver {
 		virtual void PowerOff() = 0;
 		virtual void DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) = 0;
 		virtual DriverPose_t GetPose() = 0;
-		virtual void RunFrame(TrackedDevicePose_t* poses) = 0;
+		virtual void RunFrame(AnchorCache& anchors) = 0;
 		virtual void ProcessEvent(const vr::VREvent_t& vrEvent) = 0;
 
 		virtual const char* GetModelNumber() const = 0;
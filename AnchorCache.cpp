@@ -0,0 +1,33 @@
+#include "AnchorCache.h"
+
+#include "util.h"
+
+void AnchorCache::begin_frame(int highest_device_id) {
+	converted = 0;
+	fetched_count = 0;
+
+	if (highest_device_id < 0) return;
+
+	fetched_count = ((uint32_t)highest_device_id < vr::k_unMaxTrackedDeviceCount) ? (uint32_t)highest_device_id + 1 : vr::k_unMaxTrackedDeviceCount;
+	vr::VRServerDriverHost()->GetRawTrackedDevicePoses(0, poses, fetched_count);
+}
+
+const AnchorPose* AnchorCache::get(int device_id) {
+	if ((device_id < 0) || ((uint32_t)device_id >= fetched_count)) return nullptr;
+
+	AnchorPose& anchor = anchors[device_id];
+	uint64_t bit = 1ULL << device_id;
+	if (converted & bit) return &anchor;
+
+	const vr::HmdMatrix34_t& matrix = poses[device_id].mDeviceToAbsoluteTracking;
+
+	anchor.basis = from_hmdMatrix(matrix);
+	anchor.position = Vector3(matrix.m[0][3], matrix.m[1][3], matrix.m[2][3]);
+
+	const vr::HmdVector3_t& velocity = poses[device_id].vVelocity;
+	anchor.velocity = Vector3(velocity.v[0], velocity.v[1], velocity.v[2]);
+	anchor.yaw = get_yaw(matrix);
+
+	converted |= bit;
+	return &anchor;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <openvr_driver.h>
+#include <stdint.h>
+
+#include "basis.h"
+#include "vector3.h"
+
+// a device pose converted to what the trackers use
+struct AnchorPose {
+	Basis basis;
+	Vector3 position;
+	Vector3 velocity; // m/s
+
+	// get_yaw of the device's forward (0, 0, -1)
+	double yaw;
+};
+
+// device poses for one frame. only fetches up to the highest device index anyone anchors to,
+// and converts each anchor once no matter how many trackers share it
+class AnchorCache {
+private:
+	vr::TrackedDevicePose_t poses[vr::k_unMaxTrackedDeviceCount];
+	AnchorPose anchors[vr::k_unMaxTrackedDeviceCount];
+
+	uint32_t fetched_count = 0;
+
+	// bit per device index, set once anchors[idx] is up to date for this frame
+	uint64_t converted = 0;
+
+	static_assert(vr::k_unMaxTrackedDeviceCount <= 64, "converted mask is too small");
+
+public:
+	// highest_device_id < 0 when nothing needs a pose this frame
+	void begin_frame(int highest_device_id);
+
+	// nullptr for devices that weren't fetched this frame
+	const AnchorPose* get(int device_id);
+};
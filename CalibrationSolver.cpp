@@ -0,0 +1,98 @@
+#include "CalibrationSolver.h"
+
+#include <cmath>
+
+// time constant of the window, seconds
+#define WINDOW_TAU 1.0
+
+// power iterations per sample, starting from the last mean it converges in a few
+#define EIGEN_ITERATIONS 8
+
+double CalibrationSolver::decay(timestamp_us_t& last_time, timestamp_us_t now) {
+	double dt = ((last_time != 0) && (now > last_time)) ? (now - last_time) / 1000000.0 : 0.0;
+	last_time = now;
+	return std::exp(-dt / WINDOW_TAU);
+}
+
+void CalibrationSolver::reset_yaw() {
+	yaw_cos = 0.0;
+	yaw_sin = 0.0;
+	yaw_weight = 0.0;
+	yaw_samples = 0;
+	yaw_last_time = 0;
+}
+
+void CalibrationSolver::reset_down() {
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			down_sum[i][j] = 0.0;
+	down_weight = 0.0;
+	down_samples = 0;
+	down_last_time = 0;
+	down_mean = Quat();
+}
+
+double CalibrationSolver::add_yaw(double offset, timestamp_us_t now) {
+	double k = decay(yaw_last_time, now);
+
+	yaw_cos = yaw_cos * k + std::cos(offset);
+	yaw_sin = yaw_sin * k + std::sin(offset);
+	yaw_weight = yaw_weight * k + 1.0;
+	yaw_samples++;
+
+	return std::atan2(yaw_sin, yaw_cos);
+}
+
+Quat CalibrationSolver::add_down(const Quat& rotation, timestamp_us_t now) {
+	double k = decay(down_last_time, now);
+
+	Quat q = rotation.normalized();
+	for (int i = 0; i < 4; i++)
+		for (int j = i; j < 4; j++)
+			down_sum[i][j] = down_sum[i][j] * k + q[i] * q[j];
+	down_weight = down_weight * k + 1.0;
+
+	if (down_samples == 0) down_mean = q;
+	down_samples++;
+
+	// q and -q are the same rotation, q q^T doesn't care which one came in
+	for (int iter = 0; iter < EIGEN_ITERATIONS; iter++) {
+		Quat next;
+		for (int i = 0; i < 4; i++) {
+			double v = 0.0;
+			for (int j = 0; j < 4; j++)
+				v += ((i <= j) ? down_sum[i][j] : down_sum[j][i]) * down_mean[j];
+			next[i] = v;
+		}
+
+		if (next.length_squared() < 1e-18) break;
+		down_mean = next.normalized();
+	}
+
+	return down_mean;
+}
+
+double CalibrationSolver::get_yaw_residual() const {
+	if (yaw_weight <= 0.0) return 0.0;
+
+	// circular standard deviation
+	double r = std::sqrt(yaw_cos * yaw_cos + yaw_sin * yaw_sin) / yaw_weight;
+	if (r >= 1.0) return 0.0;
+	if (r <= 1e-9) return Math_PI;
+	return std::sqrt(-2.0 * std::log(r));
+}
+
+double CalibrationSolver::get_down_residual() const {
+	if (down_weight <= 0.0) return 0.0;
+
+	// weighted mean of cos^2 of half the angle from each sample to the result
+	double sum = 0.0;
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			sum += ((i <= j) ? down_sum[i][j] : down_sum[j][i]) * down_mean[i] * down_mean[j];
+
+	double cos_sq = sum / down_weight;
+	if (cos_sq >= 1.0) return 0.0;
+	if (cos_sq <= 0.0) return Math_PI;
+	return 2.0 * std::acos(std::sqrt(cos_sq));
+}
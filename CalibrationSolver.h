@@ -0,0 +1,43 @@
+#pragma once
+
+#include "quat.h"
+#include "timeutil.h"
+
+// averages the per frame calibration results over the last second or two instead of taking
+// whichever frame the user let go on. the yaw offset is a circular mean, the down rotation is
+// the average quaternion (Markley et al. 2007): the principal eigenvector of the weighted sum
+// of q q^T. both are running sums, so memory doesn't grow with the window
+class CalibrationSolver {
+private:
+	// yaw offset
+	double yaw_cos = 0.0;
+	double yaw_sin = 0.0;
+	double yaw_weight = 0.0;
+	unsigned int yaw_samples = 0;
+	timestamp_us_t yaw_last_time = 0;
+
+	// down rotation, upper triangle of the 4x4 sum of q q^T in x, y, z, w order
+	double down_sum[4][4] = {};
+	double down_weight = 0.0;
+	unsigned int down_samples = 0;
+	timestamp_us_t down_last_time = 0;
+	Quat down_mean;
+
+	static double decay(timestamp_us_t& last_time, timestamp_us_t now);
+
+public:
+	void reset_yaw();
+	void reset_down();
+
+	// returns the yaw offset averaged over the window, radians
+	double add_yaw(double offset, timestamp_us_t now);
+
+	// returns the rotation averaged over the window
+	Quat add_down(const Quat& rotation, timestamp_us_t now);
+
+	// spread of the samples around the result, radians
+	double get_yaw_residual() const;
+	double get_down_residual() const;
+
+	unsigned int get_samples() const { return yaw_samples + down_samples; }
+};
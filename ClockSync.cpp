@@ -0,0 +1,82 @@
+#include "ClockSync.h"
+
+// exchanges slower than the best recent one by more than this are mostly queueing, skip them
+#define RTT_SLACK_US 2000.0
+
+// min rtt creeps up per exchange so a route change doesn't lock us out forever
+#define RTT_CREEP_US 50.0
+
+#define OFFSET_GAIN (1.0 / 4.0)
+#define DRIFT_GAIN (1.0 / 4.0)
+
+// drift is measured between filtered offsets this far apart, over shorter spans the offset noise dominates
+#define DRIFT_INTERVAL_US 10000000.0
+
+// phone clocks are quartz, anything past this is a bad sample
+#define MAX_DRIFT 0.001
+
+double ClockSync::offset_at(double driver_time_us) const {
+	return offset_us + drift * (driver_time_us - ref_time_us);
+}
+
+void ClockSync::add_exchange(timestamp_us_t t0, timestamp_us_t t1, timestamp_us_t t2, timestamp_us_t t3) {
+	double rtt = ((double)t3 - (double)t0) - ((double)t2 - (double)t1);
+	if (rtt < 0.0) return;
+
+	double offset = (((double)t1 - (double)t0) + ((double)t2 - (double)t3)) / 2.0;
+	double now = (double)t3;
+
+	last_rtt_us = rtt;
+
+	if (!synced) {
+		offset_us = offset;
+		ref_time_us = now;
+		drift_ref_offset_us = offset;
+		drift_ref_time_us = now;
+		min_rtt_us = rtt;
+		synced = true;
+		return;
+	}
+
+	min_rtt_us += RTT_CREEP_US;
+	if (rtt < min_rtt_us) min_rtt_us = rtt;
+
+	if (rtt > min_rtt_us + RTT_SLACK_US) return;
+
+	double predicted = offset_at(now);
+	offset_us = predicted + (offset - predicted) * OFFSET_GAIN;
+	ref_time_us = now;
+
+	double dt = now - drift_ref_time_us;
+	if (dt > DRIFT_INTERVAL_US) {
+		double measured = (offset_us - drift_ref_offset_us) / dt;
+		drift += (measured - drift) * DRIFT_GAIN;
+		if (drift > MAX_DRIFT) drift = MAX_DRIFT;
+		if (drift < -MAX_DRIFT) drift = -MAX_DRIFT;
+
+		drift_ref_offset_us = offset_us;
+		drift_ref_time_us = now;
+	}
+}
+
+timestamp_us_t ClockSync::to_driver_time(timestamp_us_t phone_time_us) const {
+	// offset changes by ppm, evaluating it at phone time instead of driver time is close enough
+	double driver_time = (double)phone_time_us - offset_at((double)phone_time_us - offset_us);
+	return (driver_time > 0.0) ? (timestamp_us_t)driver_time : 0;
+}
+
+bool ClockSync::is_synced() const {
+	return synced;
+}
+
+double ClockSync::get_offset_us() const {
+	return offset_us;
+}
+
+double ClockSync::get_drift_ppm() const {
+	return drift * 1000000.0;
+}
+
+double ClockSync::get_rtt_us() const {
+	return last_rtt_us;
+}
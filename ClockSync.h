@@ -0,0 +1,35 @@
+#pragma once
+
+#include "timeutil.h"
+
+// NTP-style offset and drift estimate between the phone's clock and ours.
+// t0 = driver send, t1 = phone receive, t2 = phone send, t3 = driver receive
+class ClockSync {
+private:
+	bool synced = false;
+
+	// phone time - driver time, at driver time ref_time
+	double offset_us = 0.0;
+	double ref_time_us = 0.0;
+
+	// d(offset)/d(driver time)
+	double drift = 0.0;
+	double drift_ref_offset_us = 0.0;
+	double drift_ref_time_us = 0.0;
+
+	double min_rtt_us = 0.0;
+	double last_rtt_us = 0.0;
+
+	double offset_at(double driver_time_us) const;
+
+public:
+	void add_exchange(timestamp_us_t t0, timestamp_us_t t1, timestamp_us_t t2, timestamp_us_t t3);
+
+	// maps a phone timestamp onto the driver's monotonic clock
+	timestamp_us_t to_driver_time(timestamp_us_t phone_time_us) const;
+
+	bool is_synced() const;
+	double get_offset_us() const;
+	double get_drift_ppm() const;
+	double get_rtt_us() const;
+};
@@ -0,0 +1,91 @@
+#include "ConfigWatcher.h"
+
+#include <fstream>
+#include <sstream>
+#include <windows.h>
+
+#include "driverlog.h"
+
+// editors tend to save in more than one write, let them finish
+#define CONFIG_SETTLE_MS 100
+
+ConfigWatcher::~ConfigWatcher() {
+	stop();
+}
+
+void ConfigWatcher::load() {
+	// a missing file means the defaults, deleting it undoes any tuning
+	std::string text;
+	std::ifstream file(path);
+	if (file) {
+		std::stringstream contents;
+		contents << file.rdbuf();
+		text = contents.str();
+	}
+
+	// the settings store lives in the same folder and changes all the time
+	if (has_loaded && text == last_text) return;
+	last_text = text;
+	has_loaded = true;
+
+	DriverConfig* config = new DriverConfig(parse_driver_config(text));
+
+	// whatever the frame thread didn't get to yet is outdated now
+	DriverConfig* outdated = pending.exchange(config, std::memory_order_acq_rel);
+	delete outdated;
+
+	DRIVER_LOG("Loaded driver config from %s", path.c_str());
+}
+
+void ConfigWatcher::run() {
+	HANDLE change = FindFirstChangeNotificationA(dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+	if (change == INVALID_HANDLE_VALUE) {
+		DRIVER_LOG("Can't watch %s for config changes (%d)", dir.c_str(), (int)GetLastError());
+		return;
+	}
+
+	HANDLE handles[2] = { (HANDLE)stop_event, change };
+	while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+		if (WaitForSingleObject((HANDLE)stop_event, CONFIG_SETTLE_MS) == WAIT_OBJECT_0) break;
+
+		load();
+
+		if (!FindNextChangeNotification(change)) break;
+	}
+
+	FindCloseChangeNotification(change);
+}
+
+void ConfigWatcher::start(const std::string& dir_v, const std::string& file_name) {
+	stop();
+
+	dir = dir_v;
+	path = dir + "\\" + file_name;
+	has_loaded = false;
+
+	load();
+
+	stop_event = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (stop_event == NULL) return;
+
+	thread = std::thread([this] { run(); });
+}
+
+void ConfigWatcher::stop() {
+	if (thread.joinable()) {
+		SetEvent((HANDLE)stop_event);
+		thread.join();
+	}
+	if (stop_event) {
+		CloseHandle((HANDLE)stop_event);
+		stop_event = nullptr;
+	}
+
+	delete pending.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+DriverConfig* ConfigWatcher::take() {
+	// cheap enough for every frame, a plain load first so there's no write when nothing changed
+	if (pending.load(std::memory_order_relaxed) == nullptr) return nullptr;
+	return pending.exchange(nullptr, std::memory_order_acq_rel);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "DriverConfig.h"
+
+// re-reads the driver config on a background thread whenever its folder changes, so the
+// frame thread never touches the file. a new config is handed over through an atomic
+// pointer and picked up between frames
+class ConfigWatcher {
+private:
+	std::string dir;
+	std::string path;
+
+	std::thread thread;
+	void* stop_event = nullptr;
+
+	// newest config nobody has taken yet
+	std::atomic<DriverConfig*> pending{ nullptr };
+
+	// watcher thread only, to skip notifications for the other files in the folder
+	std::string last_text;
+	bool has_loaded = false;
+
+	void load();
+	void run();
+
+public:
+	~ConfigWatcher();
+
+	// reads the file once right away, then keeps watching it
+	void start(const std::string& dir_v, const std::string& file_name);
+	void stop();
+
+	// config published since the last call, or nullptr. the caller owns it
+	DriverConfig* take();
+};
@@ -5,65 +5,173 @@
 #include "UDPDeviceQuatServer.h"
 
 #include "HipMoveController.h"
+#include "datadir.h"
 
-int DeviceProvider::add_tracker(const int& port) {
-	if (ports_taken.count(port) > 0) {
-		DriverLog("PORT %d IS ALREADY TAKEN!!!", port);
-		return -1;
-	}
-
-	unsigned int id = trackers.size();
-
+static RemoteTrackerSettings default_settings(const DriverConfig& config) {
 	RemoteTrackerSettings defaults;
 
 	defaults.anchor_device_id = 0;
 	defaults.offset_global = Vector3(0.0, 0.0, 0.0);
 	defaults.offset_local_device = Vector3(0.0, 0.0, 0.0);
-	defaults.offset_local_tracker = Vector3(0.0, -0.73, 0.0);
+	defaults.offset_local_tracker = config.default_offset_local_tracker;
 
 	defaults.local_rot_euler = Vector3(0.0, 0.0, 0.0);
 	defaults.global_rot_euler = Vector3(0.0, 0.0, 0.0);
 
 	defaults.yaw_offset = 0.0;
 
-	defaults.should_predict_position = false;
+	defaults.should_predict_position = config.default_predict_position;
+	defaults.position_prediction_strength = config.default_prediction_strength;
+
+	return defaults;
+}
+
+int DeviceProvider::add_tracker(const int& port) {
+	auto taken = ports_taken.find(port);
+	if (taken != ports_taken.end()) {
+		// the overlay asks again for trackers that were restored at startup
+		return (int)taken->second;
+	}
+
+	UDPDeviceQuatServer* server = new UDPDeviceQuatServer(port, timers, config);
+
+	RemoteTracker* tracker;
+	if (!parked_trackers.empty()) {
+		tracker = parked_trackers.back();
+		parked_trackers.pop_back();
+
+		if (!tracker->rebind(server, default_settings(config))) {
+			tracker->unbind();
+			parked_trackers.push_back(tracker);
+			return -1;
+		}
+	}
+	else {
+		tracker = new RemoteTracker(server, trackers_created++, default_settings(config), events);
+		vr::VRServerDriverHost()->TrackedDeviceAdded(tracker->GetSerialNumber(), vr::TrackedDeviceClass_GenericTracker, tracker);
+	}
 
-	UDPDeviceQuatServer* server = new UDPDeviceQuatServer(port);
-	RemoteTracker* tracker = new RemoteTracker(server, id, defaults);
-	vr::VRServerDriverHost()->TrackedDeviceAdded(tracker->GetSerialNumber(), vr::TrackedDeviceClass_GenericTracker, tracker);
+	return register_tracker(tracker);
+}
 
-	devices.push_back(tracker);
-	trackers.push_back(tracker);
+int DeviceProvider::register_tracker(RemoteTracker* tracker) {
+	slot_handle_t handle = trackers.insert(tracker);
+	tracker->id = handle;
 
-	ports_taken.insert({ port, true });
+	ports_taken.insert({ tracker->port_no, handle });
 
 	srv.add_tracker(tracker);
+	save_tracker(tracker);
+
+	return (int)handle;
+}
+
+void DeviceProvider::destroy_tracker(slot_handle_t handle) {
+	RemoteTracker** slot = trackers.get(handle);
+	if (!slot) return;
+
+	RemoteTracker* tracker = *slot;
+	trackers.erase(handle);
+
+	ports_taken.erase(tracker->port_no);
+	srv.remove_tracker(tracker);
+	store.remove(tracker->GetSerialNumber());
+
+	tracker->unbind();
+	parked_trackers.push_back(tracker);
+}
+
+void DeviceProvider::restore_trackers() {
+	for (const StoredTracker& stored : store.load()) {
+		if (ports_taken.count(stored.port) > 0 || stored.serial_index < trackers_created) {
+			store.remove(stored.serial);
+			continue;
+		}
+
+		// serials in between belonged to trackers destroyed last run, nothing was added for them yet
+		trackers_created = stored.serial_index;
+
+		UDPDeviceQuatServer* server = new UDPDeviceQuatServer(stored.port, timers, config);
+		RemoteTracker* tracker = new RemoteTracker(server, trackers_created++, stored.settings, events);
+		vr::VRServerDriverHost()->TrackedDeviceAdded(tracker->GetSerialNumber(), vr::TrackedDeviceClass_GenericTracker, tracker);
+
+		register_tracker(tracker);
 
-	return (int)id;
+		unsigned long long now = get_wall_time_us();
+		if (stored.has_snapshot && (stored.snapshot.taken_at <= now) && (now - stored.snapshot.taken_at < SNAPSHOT_MAX_AGE_US))
+			tracker->resume(stored.snapshot);
+	}
+
+	if (trackers.size() > 0)
+		DRIVER_LOG("Restored %d trackers from the settings store", (int)trackers.size());
+}
+
+void DeviceProvider::apply_config() {
+	DriverConfig* next = config_watcher.take();
+	if (!next) return;
+
+	// the watcher never sees it again once taken, so it's ours to free
+	config = *next;
+	delete next;
+}
+
+void DeviceProvider::save_tracker(RemoteTracker* tracker) {
+	store.save(tracker->GetSerialNumber(), tracker->serial_index, tracker->port_no, tracker->get_settings());
+}
+
+void DeviceProvider::save_all_trackers() {
+	for (auto t : trackers) {
+		save_tracker(t);
+		store.save_snapshot(t->GetSerialNumber(), t->take_snapshot());
+	}
 }
 
 EVRInitError DeviceProvider::Init(vr::IVRDriverContext* pDriverContext) {
 	VR_INIT_SERVER_DRIVER_CONTEXT(pDriverContext);
 	InitDriverLog(vr::VRDriverLog());
-	poses = (TrackedDevicePose_t*)malloc(sizeof(TrackedDevicePose_t) * k_unMaxTrackedDeviceCount);
 
 	to_overlay.init();
 	from_overlay.init();
 
+	std::string data_dir = get_data_dir();
+	if (!data_dir.empty()) {
+		// before any tracker is made, they take their defaults and timings from it
+		config_watcher.start(data_dir, "driver_config.txt");
+		apply_config();
+
+		if (store.open(data_dir + "\\tracker_settings.bin"))
+			restore_trackers();
+	}
+
+	store_timer.callback = [this]() {
+		save_all_trackers();
+		timers.schedule(store_timer, STORE_SYNC_INTERVAL_US);
+	};
+	timers.schedule(store_timer, STORE_SYNC_INTERVAL_US);
+
 	return VRInitError_None;
 }
 
 void DeviceProvider::Cleanup() {
+	config_watcher.stop();
+
+	save_all_trackers();
+	timers.cancel(store_timer);
+	store.close();
+
 	CleanupDriverLog();
 	for (auto v : trackers) {
-		delete ((RemoteTracker*)(v));
+		delete v;
+	}
+	for (auto v : parked_trackers) {
+		delete v;
 	}
 	from_overlay.destroy();
 	to_overlay.destroy();
 }
 
 
-constexpr unsigned int CURR_VERSION = 8;
+constexpr unsigned int CURR_VERSION = 23;
 
 owoEvent DeviceProvider::handle_event(const owoEvent& ev) {
 	switch (ev.type) {
@@ -72,14 +180,11 @@ owoEvent DeviceProvider::handle_event(const owoEvent& ev) {
 		case GET_TRACKERS_LEN:
 			return { .type = TRACKERS_LEN_RECEIVED, .index = (unsigned int)trackers.size() };
 		case GET_TRACKER: {
+			// by position among the live trackers, the reply carries the id to use from then on
 			if (trackers.size() <= ev.index) return noneEvent;
-			RemoteTracker* tracker = trackers[ev.index];
-			
-			if (tracker == nullptr) {
-				return noneEvent;
-			}
+			RemoteTracker* tracker = trackers.value_at(ev.index);
 
-			return { .type = TRACKER_RECEIVED, .tracker = owoTracker { tracker != nullptr, ev.index, tracker->port_no } };
+			return { .type = TRACKER_RECEIVED, .tracker = owoTracker { true, tracker->id, tracker->port_no } };
 		}
 		case BYPASS_DELAY: {
 			should_bypass_waiting = true;
@@ -88,10 +193,12 @@ owoEvent DeviceProvider::handle_event(const owoEvent& ev) {
 
 		case SET_TRACKER_SETTING:
 		case GET_TRACKER_SETTING: {
-			if (trackers.size() <= ev.trackerSetting.tracker_id) return noneEvent;
-			RemoteTracker* tracker = trackers[ev.trackerSetting.tracker_id];
-			if (tracker == nullptr) return noneEvent;
-			return tracker->process_request(ev);
+			RemoteTracker** tracker = trackers.get(ev.trackerSetting.tracker_id);
+			if (!tracker) return noneEvent;
+
+			owoEvent response = (*tracker)->process_request(ev);
+			if (ev.type == SET_TRACKER_SETTING) save_tracker(*tracker);
+			return response;
 		}
 
 		case CREATE_TRACKER: {
@@ -100,13 +207,7 @@ owoEvent DeviceProvider::handle_event(const owoEvent& ev) {
 		}
 
 		case DESTROY_TRACKER: {
-			if (trackers.size() <= ev.index) return noneEvent;
-			RemoteTracker* tracker = trackers[ev.index];
-			if (tracker == nullptr) return noneEvent;
-
-			tracker->send_invalid_pose();
-			trackers[ev.index] = nullptr;
-
+			destroy_tracker(ev.index);
 			return noneEvent;
 		}
 	}
@@ -119,9 +220,7 @@ void DeviceProvider::tick_ipc() {
 		IPCData data = from_overlay.get_data();
 
 		if (data.data_length != sizeof(owoEvent)) {
-			DriverLog("ipc tick that wanst supposed to happen");
-			DriverLog(std::to_string(data.data_length).c_str());
-			DriverLog(std::to_string(sizeof(owoEvent)).c_str());
+			DRIVER_LOG("ipc tick that wanst supposed to happen, got %d bytes instead of %d", data.data_length, (int)sizeof(owoEvent));
 			data.free();
 			return;
 		}
@@ -140,21 +239,31 @@ void DeviceProvider::tick_ipc() {
 
 
 void DeviceProvider::RunFrame() {
+	apply_config();
 	tick_ipc();
 
-	VRServerDriverHost()->GetRawTrackedDevicePoses(0, poses, k_unMaxTrackedDeviceCount);
+	int highest_anchor = -1;
+	for (auto v : trackers) {
+		int anchor = v->get_highest_anchor();
+		if (anchor > highest_anchor) highest_anchor = anchor;
+	}
+	anchors.begin_frame(highest_anchor);
 
-	for (auto v : devices) {
-		if (v == nullptr) continue;
-		v->RunFrame(poses);
+	for (auto v : trackers) {
+		v->RunFrame(anchors);
 	}
 
+	// after the devices read their sockets, so a slow frame doesn't look like a stall
+	timers.advance(get_time_us());
+
 	vr::VREvent_t vrEvent;
 	while (vr::VRServerDriverHost()->PollNextEvent(&vrEvent, sizeof(vrEvent))) {
-		for (auto v : devices) {
-			if (v == nullptr) continue;
-			v->ProcessEvent(vrEvent);
-		}
+		events.dispatch(vrEvent);
+	}
+
+	// heartbeats, handshake replies and haptics queued up this frame
+	for (auto t : trackers) {
+		t->flush_network();
 	}
 
 	srv.tick();
@@ -13,16 +13,44 @@
 
 #include "AbstractDevice.h"
 
+#include "TimerWheel.h"
+#include "SlotMap.h"
+#include "EventRouter.h"
+#include "SettingsStore.h"
+#include "ConfigWatcher.h"
+
+// how often settings the driver changes itself (calibration, drift correction) are written back,
+// along with a snapshot of every tracker's live state
+#define STORE_SYNC_INTERVAL_US 1000000
+
+// a snapshot older than this is from a previous session, not a driver restart
+#define SNAPSHOT_MAX_AGE_US 60000000ULL
+
 class DeviceProvider : public IServerTrackedDeviceProvider {
 private:
 	int add_tracker(const int& port);
-	std::vector<RemoteTracker*> trackers;
+	int register_tracker(RemoteTracker* tracker);
+	void destroy_tracker(slot_handle_t handle);
+
+	// pre-creates the trackers saved last run, before the overlay asks for them
+	void restore_trackers();
+	void save_tracker(RemoteTracker* tracker);
+	void save_all_trackers();
+
+	// swaps in the config file's latest contents, if they changed
+	void apply_config();
 
-	std::vector<AbstractDevice*> devices;
+	// live trackers only, ids given to the overlay are handles into this
+	SlotMap<RemoteTracker*> trackers;
 
+	// destroyed trackers, still known to SteamVR and reused before adding new devices
+	std::vector<RemoteTracker*> parked_trackers;
 
-	std::map<int, bool> ports_taken;
-	TrackedDevicePose_t* poses;
+	// devices added to SteamVR so far, numbers the serial of the next one
+	unsigned int trackers_created = 0;
+
+	std::map<int, slot_handle_t> ports_taken;
+	AnchorCache anchors;
 
 	Win32IPC to_overlay = Win32IPC(false, "\\\\.\\mailslot\\owoTrack-driver-pipe-to-overlay");
 	Win32IPC from_overlay = Win32IPC(true, "\\\\.\\mailslot\\owoTrack-driver-pipe-from-overlay");
@@ -34,6 +62,18 @@ private:
 
 	InfoServer srv;
 
+	// heartbeats and timeouts of every connection
+	TimerWheel timers;
+
+	EventRouter events;
+
+	SettingsStore store;
+	TimerWheel::Timer store_timer;
+
+	// only ever changed by apply_config between frames, servers keep a reference to it
+	DriverConfig config;
+	ConfigWatcher config_watcher;
+
 public:
 	virtual EVRInitError Init(vr::IVRDriverContext* pDriverContext);
 	virtual void Cleanup();
@@ -1,21 +1,94 @@
 #pragma once
 
+#include <cstdint>
+
+#include "timeutil.h"
+#include "ClockSync.h"
+
+// counters kept by the server, exposed to the overlay for diagnostics
+struct ServerStats {
+	// rotation samples replaced by a newer one before they were ever published
+	unsigned int samples_overwritten = 0;
+
+	// packet id sequence
+	unsigned int packets_lost = 0; // gaps in the id sequence, minus late arrivals
+	unsigned int packets_reordered = 0; // arrived after a newer id
+	unsigned int packets_duplicate = 0; // same id twice
+	unsigned int stream_resets = 0; // id restarted from near zero (app restart)
+
+	// RFC 3550 style interarrival jitter, microseconds
+	double jitter_us = 0.0;
+
+	// smoothed interval between consecutive packet ids, microseconds
+	double packet_interval_us = 0.0;
+
+	// outbound
+	unsigned int messages_sent = 0;
+	unsigned int send_calls = 0; // syscalls it took to send them
+
+	// failed recvfrom/sendto calls, not counting would-block
+	unsigned int socket_errors = 0;
+
+	double get_packet_rate() const {
+		return (packet_interval_us > 0.0) ? (1000000.0 / packet_interval_us) : 0.0;
+	}
+};
+
+// one gyro or accelerometer reading, with the latest of the other
+struct ImuSample {
+	timestamp_us_t time; // driver time it was received at
+	double accel[3]; // m/s^2
+	double gyro[3]; // rad/s
+};
+
+// most samples a server keeps between two frames
+#define MAX_IMU_SAMPLES 32
+
+enum ConnectionState {
+	CONN_DEAD,			// no client, or it went away
+	CONN_HANDSHAKING,	// client said hello, no data yet
+	CONN_STREAMING,		// receiving data
+	CONN_STALLED		// client known but went quiet, may come back
+};
+
+// enough of a connection to pick it back up after the driver restarts
+struct ConnectionSnapshot {
+	uint32_t client_addr = 0; // IPv4, network order
+	uint16_t client_port = 0; // network order, 0 if there was no client
+	uint16_t state = CONN_DEAD;
+};
+
 // abstract class so other implementations can be made
 // (bluetooth, etc)
 
 class DeviceQuatServer {
 public:
+	virtual ~DeviceQuatServer() {}
+
 	virtual void startListening() = 0; // set up server
 	virtual void tick() = 0; // tick
+	virtual void flush() = 0; // sends everything queued up this frame
 
 	virtual bool isDataAvailable() = 0; // true if new data is available
 	virtual double* getRotationQuaternion() = 0; // rotation quat {x, y, z, w}
 	virtual double* getGyroscope() = 0; // gyro rad/s {x, y, z}
 	virtual double* getAccel() = 0; // accelerometer m/s^2 {x, y, z}
+	virtual bool popImuSample(ImuSample& out) = 0; // every gyro/accel sample since the last call, oldest first
+
+	virtual timestamp_us_t getSampleTime() = 0; // driver time the current rotation was received at
+	virtual timestamp_us_t getSensorTime() = 0; // driver time the current rotation was measured at, if the device tells us
+	virtual const ServerStats& getStats() = 0; // diagnostics counters
+	virtual const ClockSync& getClockSync() = 0; // device clock vs driver clock
+
+	virtual void setJitterBufferEnabled(bool enabled) = 0; // smooth out bursty rotation samples
+	virtual double getJitterBufferDelay() = 0; // current playout delay in ms
 
 	virtual bool isConnectionAlive() = 0; // checks if connection is still alive
+	virtual ConnectionState getConnectionState() = 0;
+	virtual ConnectionSnapshot getConnectionSnapshot() = 0; // who we're talking to
+	virtual void resumeConnection(const ConnectionSnapshot& snapshot) = 0; // assume that client is still there and heartbeat it
 
 	virtual void buzz(float duration_s, float frequency, float amplitude) = 0; // vibrates
 
 	virtual int get_port() = 0; // returns port or other unique id
-};
\ No newline at end of file
+};
@@ -0,0 +1,89 @@
+#include "DriverConfig.h"
+
+#include <sstream>
+
+#include "driverlog.h"
+
+static bool read_value(std::istringstream& in, double& out) {
+	double v;
+	if (!(in >> v)) return false;
+	out = v;
+	return true;
+}
+
+static bool read_value(std::istringstream& in, bool& out) {
+	std::string v;
+	if (!(in >> v)) return false;
+
+	if (v == "true" || v == "1") out = true;
+	else if (v == "false" || v == "0") out = false;
+	else return false;
+
+	return true;
+}
+
+// timings and counts, a zero timing would make the timers spin
+static bool read_value(std::istringstream& in, unsigned int& out) {
+	long long v;
+	if (!(in >> v) || v <= 0 || v > 60000) return false;
+	out = (unsigned int)v;
+	return true;
+}
+
+static bool read_value(std::istringstream& in, Vector3& out) {
+	double x, y, z;
+	if (!(in >> x >> y >> z)) return false;
+	out = Vector3(x, y, z);
+	return true;
+}
+
+// the key's value, false if it's not a known key or the value doesn't parse
+static bool read_setting(DriverConfig& config, const std::string& key, std::istringstream& in) {
+	if (key == "default_offset_local_tracker") return read_value(in, config.default_offset_local_tracker);
+	if (key == "default_predict_position") return read_value(in, config.default_predict_position);
+	if (key == "default_prediction_strength") return read_value(in, config.default_prediction_strength);
+	if (key == "heartbeat_interval_ms") return read_value(in, config.heartbeat_interval_ms);
+	if (key == "stall_threshold_ms") return read_value(in, config.stall_threshold_ms);
+	if (key == "dead_threshold_ms") return read_value(in, config.dead_threshold_ms);
+	if (key == "handshake_retry_ms") return read_value(in, config.handshake_retry_ms);
+	if (key == "handshake_retries") return read_value(in, config.handshake_retries);
+	return false;
+}
+
+DriverConfig parse_driver_config(const std::string& text) {
+	DriverConfig config;
+
+	std::istringstream lines(text);
+	std::string line;
+	int line_no = 0;
+	while (std::getline(lines, line)) {
+		line_no++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+
+		size_t eq = line.find('=');
+		if (eq == std::string::npos) {
+			if (line.find_first_not_of(" \t\r") != std::string::npos)
+				DRIVER_LOG("driver config line %d: expected key = value", line_no);
+			continue;
+		}
+
+		std::istringstream key_in(line.substr(0, eq));
+		std::string key;
+		key_in >> key;
+
+		std::istringstream value_in(line.substr(eq + 1));
+		if (!read_setting(config, key, value_in))
+			DRIVER_LOG("driver config line %d: bad or unknown setting %s", line_no, key.c_str());
+	}
+
+	// a connection can't stall after it's already dead
+	if (config.stall_threshold_ms >= config.dead_threshold_ms) {
+		DRIVER_LOG("driver config: stall_threshold_ms has to be below dead_threshold_ms, using the defaults");
+		config.stall_threshold_ms = STALL_THRESHOLD_MS;
+		config.dead_threshold_ms = DEAD_THRESHOLD_MS;
+	}
+
+	return config;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "vector3.h"
+
+// milliseconds, on the monotonic clock
+#define HEARTBEAT_INTERVAL_MS 1000
+#define STALL_THRESHOLD_MS 250
+#define DEAD_THRESHOLD_MS 3000
+
+// resend the hello reply in case it got lost, until data starts flowing
+#define HANDSHAKE_RETRY_MS 500
+#define HANDSHAKE_RETRIES 3
+
+// driver wide tunables, read from driver_config.txt in the data dir and reloaded when it changes.
+// the defines above are the defaults, used for anything the file leaves out
+struct DriverConfig {
+	// what a newly created tracker starts out with
+	Vector3 default_offset_local_tracker = Vector3(0.0, -0.73, 0.0);
+	bool default_predict_position = false;
+	double default_prediction_strength = 1.0;
+
+	// connection timing, see UDPDeviceQuatServer
+	unsigned int heartbeat_interval_ms = HEARTBEAT_INTERVAL_MS;
+	unsigned int stall_threshold_ms = STALL_THRESHOLD_MS;
+	unsigned int dead_threshold_ms = DEAD_THRESHOLD_MS;
+	unsigned int handshake_retry_ms = HANDSHAKE_RETRY_MS;
+	unsigned int handshake_retries = HANDSHAKE_RETRIES;
+};
+
+// "key = value" lines, # starts a comment. bad lines are logged and skipped
+DriverConfig parse_driver_config(const std::string& text);
@@ -0,0 +1,42 @@
+#include "EventRouter.h"
+
+void EventRouter::add_device(vr::TrackedDeviceIndex_t idx, AbstractDevice* device) {
+	if (idx >= vr::k_unMaxTrackedDeviceCount) return;
+	by_device_index[idx] = device;
+}
+
+void EventRouter::add_haptic(vr::VRInputComponentHandle_t handle, AbstractDevice* device) {
+	if (handle == vr::k_ulInvalidInputComponentHandle) return;
+	by_haptic_component[handle] = device;
+}
+
+void EventRouter::remove(AbstractDevice* device) {
+	// only on activation changes, not worth another index
+	for (auto& v : by_device_index) {
+		if (v == device) v = nullptr;
+	}
+
+	for (auto it = by_haptic_component.begin(); it != by_haptic_component.end();) {
+		if (it->second == device) it = by_haptic_component.erase(it);
+		else it++;
+	}
+}
+
+void EventRouter::dispatch(const vr::VREvent_t& ev) {
+	AbstractDevice* target = nullptr;
+
+	switch (ev.eventType) {
+	case vr::VREvent_Input_HapticVibration: {
+		// trackedDeviceIndex isn't reliable for these, the component handle is
+		auto it = by_haptic_component.find(ev.data.hapticVibration.componentHandle);
+		if (it != by_haptic_component.end()) target = it->second;
+		break;
+	}
+	default:
+		if (ev.trackedDeviceIndex < vr::k_unMaxTrackedDeviceCount)
+			target = by_device_index[ev.trackedDeviceIndex];
+		break;
+	}
+
+	if (target) target->ProcessEvent(ev);
+}
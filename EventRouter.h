@@ -0,0 +1,26 @@
+#pragma once
+
+#include <openvr_driver.h>
+#include <unordered_map>
+
+#include "AbstractDevice.h"
+
+// hands each VR event only to the device it's about, instead of every device seeing every event.
+// events for nobody we know are dropped
+class EventRouter {
+private:
+	AbstractDevice* by_device_index[vr::k_unMaxTrackedDeviceCount] = {};
+	std::unordered_map<vr::VRInputComponentHandle_t, AbstractDevice*> by_haptic_component;
+
+public:
+	// events addressed to the device's own tracked device index
+	void add_device(vr::TrackedDeviceIndex_t idx, AbstractDevice* device);
+
+	// haptic vibrations for a component it created
+	void add_haptic(vr::VRInputComponentHandle_t handle, AbstractDevice* device);
+
+	// drops every registration of the device
+	void remove(AbstractDevice* device);
+
+	void dispatch(const vr::VREvent_t& ev);
+};
@@ -0,0 +1,75 @@
+#include "GyroBiasEstimator.h"
+
+#include <cmath>
+
+// time constant of the running mean/variance
+#define STATS_TAU 0.25
+
+// still means below both of these, (rad/s)^2 and (m/s^2)^2
+#define GYRO_VARIANCE_MAX 0.0004
+#define ACCEL_VARIANCE_MAX 0.05
+
+// a slow steady turn has no variance either, but a real bias is never this large
+#define MAX_BIAS 0.1
+
+// how long it has to stay still before the bias follows, and how slowly it does
+#define STILL_DWELL 0.5
+#define BIAS_TAU 2.0
+
+#define MAX_DT 0.1
+
+void GyroBiasEstimator::add_sample(const ImuSample& sample) {
+	Vector3 gyro = Vector3(sample.gyro[0], sample.gyro[1], sample.gyro[2]);
+	double accel = Vector3(sample.accel[0], sample.accel[1], sample.accel[2]).length();
+
+	if (last_time == 0) {
+		gyro_mean = gyro;
+		accel_mean = accel;
+		last_time = sample.time;
+		return;
+	}
+
+	if (sample.time <= last_time) return;
+	double dt = (sample.time - last_time) / 1000000.0;
+	last_time = sample.time;
+	if (dt > MAX_DT) dt = MAX_DT;
+
+	double alpha = 1.0 - std::exp(-dt / STATS_TAU);
+
+	gyro_mean = gyro_mean.lerp(gyro, alpha);
+	gyro_variance += ((gyro - gyro_mean).length_squared() - gyro_variance) * alpha;
+
+	accel_mean += (accel - accel_mean) * alpha;
+	accel_variance += ((accel - accel_mean) * (accel - accel_mean) - accel_variance) * alpha;
+
+	if (!is_stationary()) {
+		still_time = 0.0;
+		return;
+	}
+
+	still_time += dt;
+	if (still_time < STILL_DWELL) return;
+
+	bias = bias.lerp(gyro_mean, 1.0 - std::exp(-dt / BIAS_TAU));
+}
+
+bool GyroBiasEstimator::is_stationary() const {
+	return (gyro_variance < GYRO_VARIANCE_MAX)
+		&& (accel_variance < ACCEL_VARIANCE_MAX)
+		&& (gyro_mean.length() < MAX_BIAS);
+}
+
+void GyroBiasEstimator::restore(const Vector3& saved_bias) {
+	reset();
+	bias = saved_bias;
+}
+
+void GyroBiasEstimator::reset() {
+	bias = Vector3();
+	gyro_mean = Vector3();
+	gyro_variance = 0.0;
+	accel_mean = 0.0;
+	accel_variance = 0.0;
+	last_time = 0;
+	still_time = 0.0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "vector3.h"
+#include "DeviceQuatServer.h"
+
+// learns the gyro's zero rate offset while the phone lies still. stillness is told from
+// the short term variance of the gyro and of the accelerometer magnitude, all kept as running averages
+class GyroBiasEstimator {
+private:
+	Vector3 bias;
+
+	Vector3 gyro_mean;
+	double gyro_variance = 0.0;
+	double accel_mean = 0.0;
+	double accel_variance = 0.0;
+
+	timestamp_us_t last_time = 0;
+
+	// seconds it's been still for
+	double still_time = 0.0;
+
+public:
+	void add_sample(const ImuSample& sample);
+
+	// rad/s, to subtract from the gyro
+	const Vector3& get_bias() const { return bias; }
+	bool is_stationary() const;
+
+	// starts from a bias learned earlier, e.g. before a driver restart
+	void restore(const Vector3& saved_bias);
+
+	void reset();
+};
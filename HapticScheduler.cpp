@@ -0,0 +1,83 @@
+#include "HapticScheduler.h"
+
+// at most 40 commands per second
+#define MIN_SEND_INTERVAL_US 25000
+
+// zero length pulses are common, give them something the phone can feel
+#define MIN_PULSE_US 10000
+
+// the phone stopping this much early isn't noticeable, not worth a packet
+#define EXTEND_SLACK_US 20000
+
+#define AMPLITUDE_SLACK 0.1f
+
+void HapticScheduler::request(timestamp_us_t now, float duration_s, float frequency_v, float amplitude_v) {
+	requests++;
+
+	// a zero amplitude is how the game stops a buzz, it ends everything right away
+	if (amplitude_v <= 0.0f) {
+		active_until = now;
+		amplitude = 0.0f;
+		stop_pending = sent_until > now;
+		return;
+	}
+
+	timestamp_us_t duration_us = (duration_s > 0.0f) ? (timestamp_us_t)(duration_s * 1000000.0f) : 0;
+	if (duration_us < MIN_PULSE_US) duration_us = MIN_PULSE_US;
+
+	timestamp_us_t until = now + duration_us;
+
+	if (active_until <= now) {
+		// idle, start fresh
+		active_until = until;
+		amplitude = amplitude_v;
+		frequency = frequency_v;
+		return;
+	}
+
+	if (until > active_until) active_until = until;
+	if (amplitude_v > amplitude) {
+		amplitude = amplitude_v;
+		frequency = frequency_v;
+	}
+}
+
+bool HapticScheduler::poll(timestamp_us_t now, float& duration_s, float& frequency_out, float& amplitude_out) {
+	if ((now - last_send) < MIN_SEND_INTERVAL_US) return false;
+
+	if (active_until <= now) {
+		// only a stop leaves the phone buzzing past the end, tell it to stop too
+		if (!stop_pending || sent_until <= now) return false;
+
+		duration_s = 0.0f;
+		frequency_out = frequency;
+		amplitude_out = 0.0f;
+
+		sent_until = now;
+		sent_amplitude = 0.0f;
+		stop_pending = false;
+		last_send = now;
+		commands++;
+
+		return true;
+	}
+
+	bool phone_idle = sent_until <= now;
+	bool stronger = amplitude > sent_amplitude + AMPLITUDE_SLACK;
+	bool longer = active_until > sent_until + EXTEND_SLACK_US;
+
+	// a pulse started after a stop replaces what the phone is still doing
+	if (!phone_idle && !stronger && !longer && !stop_pending) return false;
+
+	duration_s = (float)(active_until - now) / 1000000.0f;
+	frequency_out = frequency;
+	amplitude_out = amplitude;
+
+	sent_until = active_until;
+	sent_amplitude = amplitude;
+	stop_pending = false;
+	last_send = now;
+	commands++;
+
+	return true;
+}
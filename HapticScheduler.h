@@ -0,0 +1,35 @@
+#pragma once
+
+#include "timeutil.h"
+
+// merges haptic requests from the game into as few buzz commands as possible.
+// overlapping requests keep the max amplitude and the latest end time,
+// and the phone is only told when that differs from what it was last told.
+// a zero amplitude request cancels instead of merging
+class HapticScheduler {
+private:
+	// what the game wants
+	timestamp_us_t active_until = 0;
+	float amplitude = 0.0f;
+	float frequency = 0.0f;
+
+	// what the phone was last told
+	timestamp_us_t sent_until = 0;
+	float sent_amplitude = 0.0f;
+	timestamp_us_t last_send = 0;
+
+	// the game stopped what the phone is still playing
+	bool stop_pending = false;
+
+	unsigned int requests = 0;
+	unsigned int commands = 0;
+
+public:
+	void request(timestamp_us_t now, float duration_s, float frequency_v, float amplitude_v);
+
+	// true if a buzz should go out now, with its parameters
+	bool poll(timestamp_us_t now, float& duration_s, float& frequency_out, float& amplitude_out);
+
+	unsigned int get_requests() const { return requests; }
+	unsigned int get_commands() const { return commands; }
+};
@@ -84,7 +84,7 @@ void HipMoveController::send_invalid_pose() {
 
 	VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, pose, sizeof(pose));
 }
-void HipMoveController::RunFrame(TrackedDevicePose_t* poses)
+void HipMoveController::RunFrame(AnchorCache& anchors)
 {
 	if (!enabled) {
 		SetDirection(analog_data.x, analog_data.y);
@@ -92,7 +92,8 @@ void HipMoveController::RunFrame(TrackedDevicePose_t* poses)
 	}
 
 
-	float hmdYaw = get_yaw(from_hmdMatrix(poses[0].mDeviceToAbsoluteTracking), Vector3(0, 0, -1));
+	const AnchorPose* hmd = anchors.get(0);
+	float hmdYaw = hmd ? hmd->yaw : 0.0;
 	float trackerYaw = get_yaw(tgt_tracker->get_last_basis(), Vector3(0, 0, -1));
 
 	float diff = trackerYaw - hmdYaw - 3.1415926535898;
@@ -36,7 +36,7 @@ class HipMoveController : public AbstractDevice {
 		DriverPose_t GetPose() override;
 		void send_invalid_pose();
 
-		void RunFrame(TrackedDevicePose_t* poses) override;
+		void RunFrame(AnchorCache& anchors) override;
 
 		void ProcessEvent(const vr::VREvent_t& vrEvent) override;
 
@@ -2,14 +2,20 @@
 
 #include "driverlog.h"
 
+#include <algorithm>
+
 bool InfoServer::respond_to_all_requests(){
 	sockaddr_in addr;
-	bool is_recv = Socket.RecvFrom(buff, MAX_BUFF_SIZE, reinterpret_cast<SOCKADDR*>(&addr));
-	if (!is_recv) return false;
+	int received = 0;
+
+	// whatever the error is, try again next frame
+	if (Socket.RecvFrom(buff, MAX_BUFF_SIZE, reinterpret_cast<SOCKADDR*>(&addr), received) != 0) return false;
 
 	if (strcmp(buff, "DISCOVERY\0") == 0) {
 		Socket.SendTo(addr, response_info.c_str(), response_info.length());
 	}
+
+	return true;
 }
 
 InfoServer::InfoServer(){
@@ -19,8 +25,15 @@ InfoServer::InfoServer(){
 
 void InfoServer::add_tracker(RemoteTracker *tracker){
 	list.push_back(tracker);
-	
+	update_response_info();
+}
+
+void InfoServer::remove_tracker(RemoteTracker *tracker){
+	list.erase(std::remove(list.begin(), list.end(), tracker), list.end());
+	update_response_info();
+}
 
+void InfoServer::update_response_info(){
 	response_info = "";
 	for (RemoteTracker *trk : list) {
 		response_info = response_info + std::to_string(trk->port_no) + ":" + trk->get_description() + "\n";
@@ -17,9 +17,11 @@ private:
 	bool respond_to_all_requests();
 
 	std::string response_info = "";
+	void update_response_info();
 public:
 	InfoServer();
 
 	void add_tracker(RemoteTracker *tracker);
+	void remove_tracker(RemoteTracker *tracker);
 	void tick();
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "JitterBuffer.h"
+
+// how fast the base follows arrivals that are later than expected (clock skew)
+#define BASE_SKEW_GAIN (1.0 / 256.0)
+
+void JitterBuffer::push(const RotationSample& rotation, double sender_time_us) {
+	double transit = (double)rotation.received_at - sender_time_us;
+	if (!has_base) {
+		base_us = transit;
+		has_base = true;
+	} else if (transit < base_us) {
+		base_us = transit;
+	} else {
+		base_us += (transit - base_us) * BASE_SKEW_GAIN;
+	}
+
+	if (count == CAPACITY) {
+		// full, drop the oldest
+		head = (head + 1) % CAPACITY;
+		count--;
+	}
+
+	Sample& s = samples[(head + count) % CAPACITY];
+	s.rotation = rotation;
+	s.sender_time_us = sender_time_us;
+	count++;
+}
+
+int JitterBuffer::pop_due(timestamp_us_t now, RotationSample& out) {
+	int released = 0;
+	while (count > 0) {
+		const Sample& s = samples[head];
+
+		double playout_time = s.sender_time_us + base_us + delay_us;
+		if (playout_time > (double)now) break;
+
+		out = s.rotation;
+
+		head = (head + 1) % CAPACITY;
+		count--;
+		released++;
+	}
+	return released;
+}
+
+void JitterBuffer::set_jitter(double jitter_us) {
+	delay_us = jitter_us * JITTER_MULTIPLIER;
+	if (delay_us > MAX_DELAY_US) delay_us = MAX_DELAY_US;
+}
+
+void JitterBuffer::clear() {
+	head = 0;
+	count = 0;
+	has_base = false;
+}
+
+double JitterBuffer::get_delay_ms() const {
+	return delay_us / 1000.0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "timeutil.h"
+
+struct RotationSample {
+	double quat[4] = { 0, 0, 0, 1 };
+	timestamp_us_t received_at = 0; // driver time
+	timestamp_us_t sensor_time = 0; // driver time the phone measured it, received_at if unknown
+};
+
+// playout buffer for rotation samples.
+// samples are released at sender_time + a delay sized from the measured jitter,
+// so a burst of packets comes out spread at the rate they were sent at
+class JitterBuffer {
+private:
+	struct Sample {
+		RotationSample rotation;
+		double sender_time_us;
+	};
+
+	static const int CAPACITY = 32;
+
+	Sample samples[CAPACITY];
+	int head = 0;
+	int count = 0;
+
+	// driver time of sender time 0, tracks the earliest arrivals
+	double base_us = 0.0;
+	bool has_base = false;
+
+	double delay_us = 0.0;
+
+public:
+	static constexpr double JITTER_MULTIPLIER = 3.0;
+	static constexpr double MAX_DELAY_US = 50000.0;
+
+	// sender_time_us may be on any clock as long as it's the same one for every sample
+	void push(const RotationSample& rotation, double sender_time_us);
+
+	// copies the newest sample due by now into out, returns how many samples became due
+	int pop_due(timestamp_us_t now, RotationSample& out);
+
+	// resize the playout delay from the current jitter estimate
+	void set_jitter(double jitter_us);
+
+	void clear();
+
+	double get_delay_ms() const;
+};
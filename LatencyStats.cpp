@@ -0,0 +1,47 @@
+#include "LatencyStats.h"
+
+void LatencyStats::decay() {
+	total = 0;
+	for (int i = 0; i < NUM_BUCKETS; i++) {
+		buckets[i] /= 2;
+		total += buckets[i];
+	}
+
+	prev_max_us = max_us;
+	max_us = 0;
+	since_decay = 0;
+}
+
+void LatencyStats::add(timestamp_us_t latency_us) {
+	timestamp_us_t bucket = latency_us / BUCKET_US;
+	if (bucket >= NUM_BUCKETS) bucket = NUM_BUCKETS - 1;
+
+	buckets[bucket]++;
+	total++;
+
+	if (latency_us > max_us) max_us = latency_us;
+
+	if (++since_decay >= DECAY_INTERVAL)
+		decay();
+}
+
+double LatencyStats::get_percentile(double p) const {
+	if (total == 0) return 0.0;
+
+	unsigned int target = (unsigned int)(p * (double)total);
+	unsigned int seen = 0;
+	for (int i = 0; i < NUM_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen > target) {
+			// report the middle of the bucket
+			return ((double)i + 0.5) * BUCKET_US / 1000.0;
+		}
+	}
+
+	return (double)NUM_BUCKETS * BUCKET_US / 1000.0;
+}
+
+double LatencyStats::get_max() const {
+	timestamp_us_t m = (max_us > prev_max_us) ? max_us : prev_max_us;
+	return (double)m / 1000.0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "timeutil.h"
+
+// histogram of packet-to-pose latencies, O(1) per sample. a packet's time starts when the
+// kernel received it on Windows 10 2004 and later, before that only when the frame loop read
+// it, so up to a frame of socket queueing is missing from the numbers there.
+// old samples are decayed by halving every DECAY_INTERVAL samples,
+// so the percentiles follow the last few thousand samples
+class LatencyStats {
+private:
+	static const int BUCKET_US = 250;
+	static const int NUM_BUCKETS = 256; // last bucket holds everything >= 64ms
+	static const unsigned int DECAY_INTERVAL = 4096;
+
+	unsigned int buckets[NUM_BUCKETS] = { 0 };
+	unsigned int total = 0;
+	unsigned int since_decay = 0;
+
+	timestamp_us_t max_us = 0;
+	timestamp_us_t prev_max_us = 0;
+
+	void decay();
+
+public:
+	void add(timestamp_us_t latency_us);
+
+	// returns milliseconds
+	double get_percentile(double p) const;
+	double get_max() const;
+};
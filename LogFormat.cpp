@@ -0,0 +1,218 @@
+#include "LogFormat.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+static const char* formats[MAX_LOG_FORMATS];
+static std::atomic<unsigned int> format_count(LOG_FORMAT_TEXT + 1);
+
+log_format_id_t register_log_format(const char* format) {
+	unsigned int id = format_count.fetch_add(1, std::memory_order_relaxed);
+	if (id >= MAX_LOG_FORMATS) return (log_format_id_t)MAX_LOG_FORMATS;
+
+	// published to the log thread along with the first record that uses it
+	formats[id] = format;
+	return (log_format_id_t)id;
+}
+
+const char* get_log_format(log_format_id_t id) {
+	if ((id == LOG_FORMAT_TEXT) || (id >= MAX_LOG_FORMATS)) return nullptr;
+	return formats[id];
+}
+
+
+LogRecordWriter::LogRecordWriter(char* buffer, size_t size, log_format_id_t id) {
+	record = buffer;
+	pos = buffer + LOG_RECORD_HEADER_SIZE;
+	end = buffer + size;
+
+	memcpy(record, &id, sizeof(id));
+	record[2] = 0;
+	record[3] = 0;
+}
+
+bool LogRecordWriter::fits(size_t size) {
+	if ((size_t)(end - pos) >= size) return true;
+
+	pos = end;
+	return false;
+}
+
+void LogRecordWriter::put_tagged(LogArgType type, const void* value, size_t size) {
+	if (!fits(1 + size)) return;
+
+	*pos++ = (char)type;
+	memcpy(pos, value, size);
+	pos += size;
+	record[2]++;
+}
+
+void LogRecordWriter::put_string(const char* str, size_t length) {
+	if (!fits(1 + sizeof(uint16_t))) return;
+
+	// truncated to whatever room is left
+	size_t room = end - pos - 1 - sizeof(uint16_t);
+	if (length > room) length = room;
+	uint16_t len16 = (uint16_t)length;
+
+	*pos++ = (char)LOG_ARG_STRING;
+	memcpy(pos, &len16, sizeof(len16));
+	pos += sizeof(len16);
+	memcpy(pos, str, length);
+	pos += length;
+	record[2]++;
+}
+
+void LogRecordWriter::put(const char* str) {
+	if (!str) str = "(null)";
+	put_string(str, strlen(str));
+}
+
+
+struct DecodedArg {
+	LogArgType type;
+	union {
+		int64_t i;
+		uint64_t u;
+		double d;
+	};
+	const char* str;
+	size_t str_len;
+};
+
+static bool read_arg(const char*& pos, const char* end, DecodedArg& arg) {
+	if (pos >= end) return false;
+	arg.type = (LogArgType)*pos++;
+
+	if (arg.type == LOG_ARG_STRING) {
+		uint16_t len16;
+		if ((size_t)(end - pos) < sizeof(len16)) return false;
+		memcpy(&len16, pos, sizeof(len16));
+		pos += sizeof(len16);
+
+		if ((size_t)(end - pos) < len16) return false;
+		arg.str = pos;
+		arg.str_len = len16;
+		pos += len16;
+		return true;
+	}
+
+	if ((size_t)(end - pos) < sizeof(uint64_t)) return false;
+	memcpy(&arg.u, pos, sizeof(uint64_t));
+	pos += sizeof(uint64_t);
+	return true;
+}
+
+static bool is_one_of(char c, const char* set) {
+	return (c != 0) && (strchr(set, c) != nullptr);
+}
+
+// formats one conversion with the argument converted to what the spec expects,
+// the length modifiers from the call site are replaced since every integer is stored as 64 bit
+static int format_arg(char* out, size_t out_size, const char* spec, size_t spec_len, char conv, const DecodedArg& arg) {
+	char fmt[32];
+	if (spec_len > sizeof(fmt) - 4) return snprintf(out, out_size, "?");
+
+	memcpy(fmt, spec, spec_len);
+	size_t n = spec_len;
+
+	int64_t as_int = (arg.type == LOG_ARG_DOUBLE) ? (int64_t)arg.d : arg.i;
+	double as_double = (arg.type == LOG_ARG_INT) ? (double)arg.i : (arg.type == LOG_ARG_UINT) ? (double)arg.u : arg.d;
+
+	if (arg.type == LOG_ARG_STRING) {
+		if (conv != 's') return snprintf(out, out_size, "?");
+
+		// width and precision from the call site are dropped, the copy isn't zero terminated
+		return snprintf(out, out_size, "%.*s", (int)arg.str_len, arg.str);
+	}
+
+	switch (conv) {
+	case 'd': case 'i':
+		fmt[n++] = 'l'; fmt[n++] = 'l'; fmt[n++] = conv; fmt[n] = 0;
+		return snprintf(out, out_size, fmt, (long long)as_int);
+	case 'u': case 'x': case 'X': case 'o':
+		fmt[n++] = 'l'; fmt[n++] = 'l'; fmt[n++] = conv; fmt[n] = 0;
+		return snprintf(out, out_size, fmt, (unsigned long long)as_int);
+	case 'c':
+		fmt[n++] = conv; fmt[n] = 0;
+		return snprintf(out, out_size, fmt, (int)as_int);
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		fmt[n++] = conv; fmt[n] = 0;
+		return snprintf(out, out_size, fmt, as_double);
+	case 'p':
+		fmt[n++] = conv; fmt[n] = 0;
+		return snprintf(out, out_size, fmt, (void*)(uintptr_t)arg.u);
+	default:
+		return snprintf(out, out_size, "?");
+	}
+}
+
+void decode_log_record(const char* record, size_t record_size, char* out, size_t out_size) {
+	if (out_size == 0) return;
+	out[0] = 0;
+	if (record_size < LOG_RECORD_HEADER_SIZE) return;
+
+	log_format_id_t id;
+	memcpy(&id, record, sizeof(id));
+	int arg_count = (unsigned char)record[2];
+
+	const char* pos = record + LOG_RECORD_HEADER_SIZE;
+	const char* end = record + record_size;
+
+	if (id == LOG_FORMAT_TEXT) {
+		snprintf(out, out_size, "%.*s", (int)strnlen(pos, end - pos), pos);
+		return;
+	}
+
+	const char* format = get_log_format(id);
+	if (!format) {
+		snprintf(out, out_size, "(unregistered log format %u)", (unsigned int)id);
+		return;
+	}
+
+	size_t written = 0;
+	auto advance = [&](int n) {
+		if (n > 0) written += n;
+		if (written >= out_size) written = out_size - 1;
+	};
+
+	const char* f = format;
+	while (*f && (written < out_size - 1)) {
+		if (*f != '%') {
+			out[written++] = *f++;
+			continue;
+		}
+
+		// %[flags][width][.precision][length]conversion
+		const char* spec = f++;
+		while (is_one_of(*f, "-+ #0")) f++;
+		while ((*f >= '0') && (*f <= '9')) f++;
+		if (*f == '.') {
+			f++;
+			while ((*f >= '0') && (*f <= '9')) f++;
+		}
+		size_t spec_len = f - spec;
+		while (is_one_of(*f, "hlLjzt")) f++;
+
+		char conv = *f;
+		if (conv == 0) break;
+		f++;
+
+		if (conv == '%') {
+			out[written++] = '%';
+			continue;
+		}
+
+		DecodedArg arg;
+		if ((arg_count <= 0) || !read_arg(pos, end, arg)) {
+			advance(snprintf(out + written, out_size - written, "?"));
+			continue;
+		}
+		arg_count--;
+
+		advance(format_arg(out + written, out_size - written, spec, spec_len, conv, arg));
+	}
+
+	out[written] = 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+// log records are a format id plus the raw arguments, the format string is only
+// applied when the log thread decodes them. keeps vsnprintf off the caller's thread
+
+typedef uint16_t log_format_id_t;
+
+// record holding text that was already formatted, for plain DriverLog
+#define LOG_FORMAT_TEXT 0
+#define MAX_LOG_FORMATS 1024
+
+// called once per call site, from the function local static DRIVER_LOG sets up
+log_format_id_t register_log_format(const char* format);
+
+// nullptr for ids that were never handed out
+const char* get_log_format(log_format_id_t id);
+
+/*
+record layout (host byte order):
+2 bytes - format id
+1 byte - argument count
+1 byte - unused
+then per argument:
+1 byte - LogArgType
+8 bytes - the value, or for strings 2 bytes length + the characters
+*/
+#define LOG_RECORD_HEADER_SIZE 4
+
+enum LogArgType : uint8_t {
+	LOG_ARG_INT,
+	LOG_ARG_UINT,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER
+};
+
+class LogRecordWriter {
+private:
+	char* record;
+	char* pos;
+	char* end;
+
+	// false once an argument didn't fit, the rest are dropped too
+	bool fits(size_t size);
+	void put_tagged(LogArgType type, const void* value, size_t size);
+	void put_string(const char* str, size_t length);
+
+public:
+	LogRecordWriter(char* buffer, size_t size, log_format_id_t id);
+
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type put(T v) {
+		int64_t value = v;
+		put_tagged(LOG_ARG_INT, &value, sizeof(value));
+	}
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type put(T v) {
+		uint64_t value = v;
+		put_tagged(LOG_ARG_UINT, &value, sizeof(value));
+	}
+	template<typename T>
+	typename std::enable_if<std::is_enum<T>::value>::type put(T v) {
+		put((typename std::underlying_type<T>::type)v);
+	}
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<T>::value>::type put(T v) {
+		double value = v;
+		put_tagged(LOG_ARG_DOUBLE, &value, sizeof(value));
+	}
+	template<typename T>
+	void put(T* v) {
+		uint64_t value = (uintptr_t)v;
+		put_tagged(LOG_ARG_POINTER, &value, sizeof(value));
+	}
+
+	// strings are copied, the pointer may not be valid by the time the record is decoded
+	void put(const char* str);
+	void put(char* str) { put((const char*)str); }
+	void put(const std::string& str) { put_string(str.c_str(), str.length()); }
+
+	// in argument order. an initializer list rather than a fold, the Debug|x64 build is still C++14
+	template<typename... Args>
+	void put_all(const Args&... args) {
+		int expand[] = { 0, (put(args), 0)... };
+		(void)expand;
+	}
+};
+
+// turns a record back into text, always zero terminates out
+void decode_log_record(const char* record, size_t record_size, char* out, size_t out_size);
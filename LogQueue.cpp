@@ -0,0 +1,55 @@
+#include "LogQueue.h"
+
+static_assert((LogQueue::MAX_ENTRIES & (LogQueue::MAX_ENTRIES - 1)) == 0, "log queue size must be a power of two");
+
+#define SLOT_MASK (LogQueue::MAX_ENTRIES - 1)
+
+// per slot sequence numbers, as in Vyukov's bounded queue: a slot is free for the
+// producer at position pos when its sequence is pos, and ready for the consumer when it's pos + 1
+LogQueue::LogQueue() : enqueue_pos(0), dropped(0) {
+	for (size_t i = 0; i < MAX_ENTRIES; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+char* LogQueue::reserve(size_t& ticket) {
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = slots[pos & SLOT_MASK];
+		size_t seq = slot.sequence.load(std::memory_order_acquire);
+		ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+
+		if (diff == 0) {
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				ticket = pos;
+				return slot.data;
+			}
+		}
+		else if (diff < 0) {
+			// consumer hasn't caught up
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else {
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void LogQueue::commit(size_t ticket) {
+	slots[ticket & SLOT_MASK].sequence.store(ticket + 1, std::memory_order_release);
+}
+
+const char* LogQueue::peek() {
+	Slot& slot = slots[dequeue_pos & SLOT_MASK];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) return nullptr;
+	return slot.data;
+}
+
+void LogQueue::pop() {
+	slots[dequeue_pos & SLOT_MASK].sequence.store(dequeue_pos + MAX_ENTRIES, std::memory_order_release);
+	dequeue_pos++;
+}
+
+unsigned int LogQueue::take_dropped() {
+	return dropped.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+// bounded lock-free queue of log records (see LogFormat.h), any thread can push,
+// only the log thread pops. pushing never waits, a full queue drops the record
+class LogQueue {
+public:
+	static const size_t MAX_ENTRIES = 256; // power of two
+	static const size_t MAX_ENTRY_SIZE = 512;
+
+private:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		char data[MAX_ENTRY_SIZE];
+	};
+
+	Slot slots[MAX_ENTRIES];
+
+	// producers and the consumer on separate cache lines
+	alignas(64) std::atomic<size_t> enqueue_pos;
+	alignas(64) size_t dequeue_pos = 0;
+
+	std::atomic<unsigned int> dropped;
+
+public:
+	LogQueue();
+
+	// returns a MAX_ENTRY_SIZE slot to write a record into, or nullptr if the queue is full.
+	// the record isn't visible to the consumer until commit(ticket)
+	char* reserve(size_t& ticket);
+	void commit(size_t ticket);
+
+	// consumer side, oldest committed record or nullptr
+	const char* peek();
+	void pop();
+
+	// records dropped since the last call
+	unsigned int take_dropped();
+};
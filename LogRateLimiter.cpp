@@ -0,0 +1,57 @@
+#include "LogRateLimiter.h"
+
+#include <stdint.h>
+
+LogRateLimiter::Site* LogRateLimiter::find_site(const char* format) {
+	// format strings are at least 4 byte aligned in practice
+	size_t start = ((uintptr_t)format >> 2) * 2654435761u;
+
+	for (int i = 0; i < MAX_SITES; i++) {
+		Site& site = sites[(start + i) & (MAX_SITES - 1)];
+
+		const char* key = site.format.load(std::memory_order_acquire);
+		if (key == format) return &site;
+		if (key != nullptr) continue;
+
+		// claim the empty site, or find out someone else just did
+		if (site.format.compare_exchange_strong(key, format, std::memory_order_acq_rel) || (key == format))
+			return &site;
+	}
+
+	return nullptr;
+}
+
+bool LogRateLimiter::allow(const char* format, timestamp_us_t now) {
+	Site* site = find_site(format);
+
+	// more call sites than slots, those just aren't limited
+	if (!site) return true;
+
+	timestamp_us_t window_start = site->window_start.load(std::memory_order_relaxed);
+	if (now - window_start >= LOG_RATE_WINDOW_US) {
+		// only one thread gets to start the new window
+		if (site->window_start.compare_exchange_strong(window_start, now, std::memory_order_relaxed))
+			site->count.store(0, std::memory_order_relaxed);
+	}
+
+	if (site->count.fetch_add(1, std::memory_order_relaxed) < LOG_RATE_LIMIT) return true;
+
+	site->suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+bool LogRateLimiter::take_suppressed(int& idx, const char*& format, unsigned int& count) {
+	for (; idx < MAX_SITES; idx++) {
+		Site& site = sites[idx];
+		if (site.format.load(std::memory_order_acquire) == nullptr) continue;
+
+		count = site.suppressed.exchange(0, std::memory_order_relaxed);
+		if (count == 0) continue;
+
+		format = site.format.load(std::memory_order_relaxed);
+		idx++;
+		return true;
+	}
+
+	return false;
+}
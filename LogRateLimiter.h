@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include "timeutil.h"
+
+// lines per call site per window before the rest are suppressed
+#define LOG_RATE_LIMIT 10
+#define LOG_RATE_WINDOW_US 1000000
+
+// call sites are told apart by their format string pointer, which is kept for the summaries,
+// so only formats that live forever (the literals registered by DRIVER_LOG) can be limited
+class LogRateLimiter {
+public:
+	static const int MAX_SITES = 128; // power of two
+
+private:
+	struct Site {
+		std::atomic<const char*> format{ nullptr };
+		std::atomic<timestamp_us_t> window_start{ 0 };
+		std::atomic<unsigned int> count{ 0 };
+		std::atomic<unsigned int> suppressed{ 0 };
+	};
+
+	Site sites[MAX_SITES];
+
+	Site* find_site(const char* format);
+
+public:
+	// lock free, callable from any thread
+	bool allow(const char* format, timestamp_us_t now);
+
+	// for the log thread, walks the sites with lines suppressed since the last call,
+	// returns false once there are none left. start with idx = 0
+	bool take_suppressed(int& idx, const char*& format, unsigned int& count);
+};
@@ -5,12 +5,32 @@
 #define  _WINSOCK_DEPRECATED_NO_WARNINGS
 #include <WinSock2.h>
 #include <WS2tcpip.h>
+#include <mswsock.h>
+#include <mstcpip.h>
 #include <system_error>
 #include <string>
+#include <cstring>
 #include <iostream>
 
+#include "timeutil.h"
+
 #pragma comment(lib, "Ws2_32.lib")
 
+// receive timestamps, from Windows 10 2004. older SDKs don't have them
+#ifndef SIO_TIMESTAMPING
+#define SIO_TIMESTAMPING _WSAIOW(IOC_VENDOR, 235)
+#define TIMESTAMPING_FLAG_RX 0x1
+
+typedef struct _TIMESTAMPING_CONFIG {
+    ULONG Flags;
+    USHORT TxTimestampsBuffered;
+} TIMESTAMPING_CONFIG;
+#endif
+
+#ifndef SO_TIMESTAMP
+#define SO_TIMESTAMP 0x300A
+#endif
+
 class WSASession
 {
 public:
@@ -35,11 +55,18 @@ public:
     {
         sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
         
-        unsigned long ul = 1;
-        ioctlsocket(sock, FIONBIO, (unsigned long*)&ul);
-        
         if (sock == INVALID_SOCKET)
             throw std::system_error(WSAGetLastError(), std::system_category(), "Error opening socket");
+
+        unsigned long ul = 1;
+        ioctlsocket(sock, FIONBIO, (unsigned long*)&ul);
+
+        // an ICMP port unreachable from a closed phone app would otherwise fail the next recvfrom with WSAECONNRESET
+        BOOL report_connreset = FALSE;
+        DWORD bytes_returned = 0;
+        WSAIoctl(sock, SIO_UDP_CONNRESET, &report_connreset, sizeof(report_connreset), NULL, 0, &bytes_returned, NULL, NULL);
+
+        EnableRxTimestamps();
     }
     ~UDPSocket()
     {
@@ -56,29 +83,83 @@ public:
         if (ret < 0)
             throw std::system_error(WSAGetLastError(), std::system_category(), "sendto failed");
     }
-    void SendTo(sockaddr_in& address, const char* buffer, int len, int flags = 0)
+    // the hot path doesn't throw, these return 0 or the WSA error code
+    int SendTo(sockaddr_in& address, const char* buffer, int len, int flags = 0)
     {
         int ret = sendto(sock, buffer, len, flags, reinterpret_cast<SOCKADDR*>(&address), sizeof(address));
         if (ret < 0)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "sendto failed");
+            return WSAGetLastError();
+        return 0;
     }
-    bool RecvFrom(char* buffer, int len, SOCKADDR* from, int flags = 0)
+    // WSAEWOULDBLOCK when there's nothing to read
+    int RecvFrom(char* buffer, int len, SOCKADDR* from, int& received, int flags = 0)
     {
         int size = sizeof(sockaddr_in); // reinterpret_cast<SOCKADDR*>(&from)
-        int ret = recvfrom(sock, buffer, len, flags, from, &size);
-        if (ret == WSAEWOULDBLOCK)
-            return false;
-        else if (ret < 0) {
-            int err = WSAGetLastError();
-            if (err == WSAEWOULDBLOCK) {
-                return false;
+        int ret = recvfrom(sock, buffer, len - 1, flags, from, &size);
+        if (ret < 0) {
+            received = 0;
+            return WSAGetLastError();
+        }
+
+        // make the buffer zero terminated
+        buffer[ret] = 0;
+        received = ret;
+        return 0;
+    }
+    // same, along with when the datagram arrived on the driver's clock. that's the kernel's
+    // stamp where there is one, otherwise the time it's read, which misses the time it sat queued
+    int RecvFrom(char* buffer, int len, SOCKADDR* from, int& received, timestamp_us_t& received_at, int flags = 0)
+    {
+        if (!recv_msg) {
+            int err = RecvFrom(buffer, len, from, received, flags);
+            received_at = get_time_us();
+            return err;
+        }
+
+        WSABUF data;
+        data.buf = buffer;
+        data.len = len - 1;
+
+        char control[WSA_CMSG_SPACE(sizeof(UINT64))];
+
+        WSAMSG msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.name = from;
+        msg.namelen = sizeof(sockaddr_in);
+        msg.lpBuffers = &data;
+        msg.dwBufferCount = 1;
+        msg.Control.buf = control;
+        msg.Control.len = sizeof(control);
+        msg.dwFlags = flags;
+
+        DWORD ret = 0;
+        if (recv_msg(sock, &msg, &ret, NULL, NULL) == SOCKET_ERROR) {
+            received = 0;
+            return WSAGetLastError();
+        }
+
+        LARGE_INTEGER now_qpc;
+        QueryPerformanceCounter(&now_qpc);
+        received_at = get_time_us();
+
+        // the stamp is in performance counter ticks, only how long ago it was is carried over
+        for (WSACMSGHDR* cmsg = WSA_CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = WSA_CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_TIMESTAMP) continue;
+
+            UINT64 stamp;
+            memcpy(&stamp, WSA_CMSG_DATA(cmsg), sizeof(stamp));
+
+            UINT64 now_ticks = (UINT64)now_qpc.QuadPart;
+            if (stamp <= now_ticks) {
+                timestamp_us_t age_us = (timestamp_us_t)((double)(now_ticks - stamp) * 1000000.0 / (double)qpc_frequency);
+                if (age_us < received_at) received_at -= age_us;
             }
-            throw std::system_error(err, std::system_category(), "recvfrom failed");
         }
 
         // make the buffer zero terminated
         buffer[ret] = 0;
-        return true;
+        received = (int)ret;
+        return 0;
     }
     void Bind(unsigned short port)
     {
@@ -92,6 +173,65 @@ public:
             throw std::system_error(WSAGetLastError(), std::system_category(), "Bind failed");
     }
 
+    bool HasRxTimestamps() const
+    {
+        return recv_msg != NULL;
+    }
+
 //private:
     SOCKET sock;
-};
\ No newline at end of file
+
+private:
+    // set when the kernel stamps received datagrams
+    LPFN_WSARECVMSG recv_msg = NULL;
+    UINT64 qpc_frequency = 0;
+
+    void EnableRxTimestamps()
+    {
+        TIMESTAMPING_CONFIG config;
+        memset(&config, 0, sizeof(config));
+        config.Flags = TIMESTAMPING_FLAG_RX;
+
+        DWORD bytes_returned = 0;
+        if (WSAIoctl(sock, SIO_TIMESTAMPING, &config, sizeof(config), NULL, 0, &bytes_returned, NULL, NULL) == SOCKET_ERROR)
+            return;
+
+        DWORD enabled = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMP, (const char*)&enabled, sizeof(enabled)) == SOCKET_ERROR)
+            return;
+
+        LARGE_INTEGER frequency;
+        if (!QueryPerformanceFrequency(&frequency) || frequency.QuadPart <= 0)
+            return;
+
+        // the control messages only come through WSARecvMsg, which has to be looked up
+        GUID recv_msg_id = WSAID_WSARECVMSG;
+        LPFN_WSARECVMSG fn = NULL;
+        if (WSAIoctl(sock, SIO_GET_EXTENSION_FUNCTION_POINTER, &recv_msg_id, sizeof(recv_msg_id), &fn, sizeof(fn), &bytes_returned, NULL, NULL) == SOCKET_ERROR)
+            return;
+
+        qpc_frequency = (UINT64)frequency.QuadPart;
+        recv_msg = fn;
+    }
+};
+
+// errors that go away on their own, as opposed to ones that mean the socket is unusable
+inline bool is_transient_socket_error(int err)
+{
+    switch (err) {
+    case WSAEWOULDBLOCK:
+    case WSAEINTR:
+    case WSAEINPROGRESS:
+    case WSAEMSGSIZE: // oversized datagram, it's dropped
+    case WSAECONNRESET: // ICMP port unreachable
+    case WSAENETRESET:
+    case WSAENETUNREACH:
+    case WSAEHOSTUNREACH:
+    case WSAENETDOWN:
+    case WSAENOBUFS:
+    case WSAETIMEDOUT:
+        return true;
+    default:
+        return false;
+    }
+}
\ No newline at end of file
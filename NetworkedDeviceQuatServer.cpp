@@ -1,50 +1,195 @@
 #include "NetworkedDeviceQuatServer.h"
 #include <stdlib.h>
+#include <cmath>
+
+// gain of the jitter and interval filters, 1/16 as in RFC 3550
+#define ARRIVAL_FILTER_GAIN (1.0 / 16.0)
+
+// the phone doesn't send its own timestamps, so its clock is approximated
+// by the packet id times the smoothed interval between ids
+void NetworkedDeviceQuatServer::update_arrival_stats(message_id_t new_id) {
+	if ((current_packet_time == 0) || (new_id <= current_packet_id)) return;
+
+	double id_delta = (double)(new_id - current_packet_id);
+	double arrival_delta = (double)(packet_time - current_packet_time);
+
+	if (stats.packet_interval_us == 0.0) {
+		stats.packet_interval_us = arrival_delta / id_delta;
+		sender_clock_us += arrival_delta;
+		return;
+	}
+
+	sender_clock_us += id_delta * stats.packet_interval_us;
+
+	double transit_delta = arrival_delta - id_delta * stats.packet_interval_us;
+	stats.jitter_us += (std::abs(transit_delta) - stats.jitter_us) * ARRIVAL_FILTER_GAIN;
+
+	stats.packet_interval_us += (arrival_delta / id_delta - stats.packet_interval_us) * ARRIVAL_FILTER_GAIN;
+}
 
 bool NetworkedDeviceQuatServer::receive_packet_id(message_id_t new_id) {
-	if ((new_id > current_packet_id) || (new_id < 5)) {
+	if (new_id > current_packet_id) {
+		if ((current_packet_id != 0) && (new_id > current_packet_id + 1))
+			stats.packets_lost += (unsigned int)(new_id - current_packet_id - 1);
+
+		update_arrival_stats(new_id);
+
+		current_packet_id = new_id;
+		current_packet_time = packet_time;
+		return true;
+	}
+
+	if (new_id < 5) {
+		// app restarted, start counting from scratch
+		stats.stream_resets++;
+
 		current_packet_id = new_id;
+		current_packet_time = packet_time;
 		return true;
 	}
+
+	if (new_id == current_packet_id) {
+		stats.packets_duplicate++;
+	} else {
+		// was counted as lost when the newer id came in
+		stats.packets_reordered++;
+		if (stats.packets_lost > 0) stats.packets_lost--;
+	}
+
 	return false;
 }
 
-void NetworkedDeviceQuatServer::handle_doubles_packet(unsigned char* packet, double* into, int num_doubles) {
-	packet += sizeof(message_header_type_t);
+bool NetworkedDeviceQuatServer::handle_vector3_packet(const PacketReader<Vector3Packet, IN_ORDER>& r, double* into) {
+	if (!receive_packet_id(r.get<1>())) return false;
 
-	message_id_t id = convert_chars<message_id_t>(packet);
-	packet += sizeof(message_id_t);
-	if (!receive_packet_id(id)) return;
+	into[0] = r.get<2>();
+	into[1] = r.get<3>();
+	into[2] = r.get<4>();
 
-	for (int i = 0; i < num_doubles; i++) {
-		sensor_data_t data = convert_chars<sensor_data_t>(packet);
-		packet += sizeof(sensor_data_t);
-		into[i] = (double)data;
+	isNewDataAvailable = true;
+	return true;
+}
+
+void NetworkedDeviceQuatServer::push_imu_sample() {
+	if (imu_count == MAX_IMU_SAMPLES) {
+		imu_first = (imu_first + 1) % MAX_IMU_SAMPLES;
+		imu_count--;
 	}
 
-	isNewDataAvailable = true;
+	ImuSample& sample = imu_samples[(imu_first + imu_count) % MAX_IMU_SAMPLES];
+	imu_count++;
+
+	sample.time = packet_time;
+	for (int i = 0; i < 3; i++) {
+		sample.accel[i] = accel_buffer[i];
+		sample.gyro[i] = gyro_buffer[i];
+	}
 }
 
+bool NetworkedDeviceQuatServer::popImuSample(ImuSample& out) {
+	if (imu_count == 0) return false;
+
+	out = imu_samples[imu_first];
+	imu_first = (imu_first + 1) % MAX_IMU_SAMPLES;
+	imu_count--;
+	return true;
+}
+
+
+bool NetworkedDeviceQuatServer::handle_gyro_packet(const unsigned char* packet, size_t length){
+	PacketReader<Vector3Packet, IN_ORDER> r(packet, length);
+	if (!r.valid()) return false;
+
+	if (handle_vector3_packet(r, gyro_buffer))
+		push_imu_sample();
+	return true;
+}
+bool NetworkedDeviceQuatServer::handle_rotation_packet(const unsigned char* packet, size_t length){
+	PacketReader<RotationPacket, IN_ORDER> r(packet, length);
+	if (!r.valid()) return false;
+	if (!receive_packet_id(r.get<1>())) return true;
+
+	double quat[4] = { r.get<2>(), r.get<3>(), r.get<4>(), r.get<5>() };
+	accept_rotation(quat, false, 0);
+	return true;
+}
+bool NetworkedDeviceQuatServer::handle_timestamped_rotation_packet(const unsigned char* packet, size_t length) {
+	PacketReader<RotationTimestampedPacket, IN_ORDER> r(packet, length);
+	if (!r.valid()) return false;
+	if (!receive_packet_id(r.get<1>())) return true;
+
+	double quat[4] = { r.get<2>(), r.get<3>(), r.get<4>(), r.get<5>() };
+	accept_rotation(quat, true, r.get<6>());
+	return true;
+}
+bool NetworkedDeviceQuatServer::handle_accel_packet(const unsigned char* packet, size_t length){
+	PacketReader<Vector3Packet, IN_ORDER> r(packet, length);
+	if (!r.valid()) return false;
 
-void NetworkedDeviceQuatServer::handle_gyro_packet(unsigned char* packet){
-	handle_doubles_packet(packet, gyro_buffer, 3);
+	if (handle_vector3_packet(r, accel_buffer))
+		push_imu_sample();
+	return true;
 }
-void NetworkedDeviceQuatServer::handle_rotation_packet(unsigned char* packet){
-	handle_doubles_packet(packet, quat_buffer, 4);
+
+bool NetworkedDeviceQuatServer::handle_clock_sync_packet(const unsigned char* packet, size_t length) {
+	PacketReader<ClockSyncPacket, IN_ORDER> r(packet, length);
+	if (!r.valid()) return false;
+
+	// only for the sequence stats, a late reply is still a valid measurement
+	receive_packet_id(r.get<1>());
+
+	clock.add_exchange(r.get<2>(), r.get<3>(), r.get<4>(), packet_time);
+	return true;
 }
-void NetworkedDeviceQuatServer::handle_accel_packet(unsigned char* packet){
-	handle_doubles_packet(packet, accel_buffer, 3);
+
+void NetworkedDeviceQuatServer::accept_rotation(const double* quat, bool has_phone_time, message_timestamp_t phone_time) {
+	RotationSample sample;
+	for (int i = 0; i < 4; i++) sample.quat[i] = quat[i];
+	sample.received_at = packet_time;
+
+	bool synced = has_phone_time && clock.is_synced();
+	sample.sensor_time = synced ? clock.to_driver_time(phone_time) : packet_time;
+
+	if (use_jitter_buffer) {
+		// sender times from different clocks can't share a playout base
+		if (synced != jitter_buffer_synced) {
+			jitter_buffer.clear();
+			jitter_buffer_synced = synced;
+		}
+
+		// released later by isDataAvailable
+		jitter_buffer.push(sample, synced ? (double)sample.sensor_time : sender_clock_us);
+		return;
+	}
+
+	if (isRotationPending)
+		stats.samples_overwritten++;
+
+	rotation = sample;
+	isNewDataAvailable = true;
+	isRotationPending = true;
 }
 
 
 bool NetworkedDeviceQuatServer::isDataAvailable() {
+	if (use_jitter_buffer) {
+		jitter_buffer.set_jitter(stats.jitter_us);
+
+		int released = jitter_buffer.pop_due(get_time_us(), rotation);
+		if (released > 0) {
+			stats.samples_overwritten += released - 1;
+			isNewDataAvailable = true;
+		}
+	}
+
 	bool was_available = isNewDataAvailable;
 	isNewDataAvailable = false;
+	isRotationPending = false;
 	return was_available;
 }
 
 double* NetworkedDeviceQuatServer::getRotationQuaternion() {
-	return quat_buffer;
+	return rotation.quat;
 }
 
 double* NetworkedDeviceQuatServer::getGyroscope() {
@@ -55,12 +200,42 @@ double* NetworkedDeviceQuatServer::getAccel() {
 	return accel_buffer;
 }
 
+timestamp_us_t NetworkedDeviceQuatServer::getSampleTime() {
+	return rotation.received_at;
+}
+
+timestamp_us_t NetworkedDeviceQuatServer::getSensorTime() {
+	return rotation.sensor_time;
+}
+
+const ClockSync& NetworkedDeviceQuatServer::getClockSync() {
+	return clock;
+}
+
+const ServerStats& NetworkedDeviceQuatServer::getStats() {
+	return stats;
+}
+
+void NetworkedDeviceQuatServer::setJitterBufferEnabled(bool enabled) {
+	if (enabled == use_jitter_buffer) return;
+
+	use_jitter_buffer = enabled;
+	jitter_buffer.clear();
+}
+
+double NetworkedDeviceQuatServer::getJitterBufferDelay() {
+	return use_jitter_buffer ? jitter_buffer.get_delay_ms() : 0.0;
+}
+
 #define HELLOMESSAGE (" Hey OVR =D 5")
 
 NetworkedDeviceQuatServer::NetworkedDeviceQuatServer(){
-	quat_buffer = (double*)malloc(sizeof(double) * 4);
 	gyro_buffer = (double*)malloc(sizeof(double) * 3);
 	accel_buffer = (double*)malloc(sizeof(double) * 3);
+	for (int i = 0; i < 3; i++) {
+		gyro_buffer[i] = 0.0;
+		accel_buffer[i] = 0.0;
+	}
 
 	buff_hello = (char*)malloc(sizeof(HELLOMESSAGE));
 
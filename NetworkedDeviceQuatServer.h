@@ -1,6 +1,9 @@
 #pragma once
 
 #include "DeviceQuatServer.h"
+#include "JitterBuffer.h"
+#include "ClockSync.h"
+#include "Packet.h"
 
 #define MSG_HEARTBEAT 0
 #define MSG_ROTATION 1
@@ -8,9 +11,18 @@
 #define MSG_HANDSHAKE 3
 #define MSG_ACCELEROMETER 4
 
-typedef unsigned int message_header_type_t;
-typedef unsigned long long message_id_t;
+// owoTrack extensions, kept clear of the SlimeVR ids
+#define MSG_CLOCK_SYNC 32
+#define MSG_ROTATION_TIMESTAMPED 33
+
+// driver -> phone
+#define MSG_OUT_HEARTBEAT 1
+#define MSG_OUT_BUZZ 2
+
+typedef uint32_t message_header_type_t;
+typedef uint64_t message_id_t;
 typedef float sensor_data_t;
+typedef uint64_t message_timestamp_t;
 
 // message type + packet id
 #define MSG_HEADER_SIZE (sizeof(message_header_type_t) + sizeof(message_id_t))
@@ -41,46 +53,104 @@ next 4 bytes - gyro rate x
 next 4 bytes - gyro rate y
 next 4 bytes - gyro rate z
 
+clock sync (reply to the driver time in a heartbeat):
+next 8 bytes - driver time from the heartbeat, echoed back (t0)
+next 8 bytes - phone time the heartbeat was received (t1)
+next 8 bytes - phone time this reply was sent (t2)
+
+rotation timestamped:
+same as rotation, then
+next 8 bytes - phone time the rotation was measured at
+
+all timestamps are microseconds, phones that don't know these just never send them
+
 
 64 byte packets
 */
 
-template<typename T>
-T convert_chars(unsigned char* src) {
-	union {
-		unsigned char c[sizeof(T)];
-		T v;
-	} un;
-	for (int i = 0; i < sizeof(T); i++) {
-		un.c[i] = src[sizeof(T) - i - 1];
-	}
-	return un.v;
-}
+// phone -> driver, big endian
+typedef PacketLayout<message_header_type_t> PacketHeader;
+typedef PacketLayout<message_header_type_t, message_id_t,
+	sensor_data_t, sensor_data_t, sensor_data_t> Vector3Packet; // gyro, accelerometer
+typedef PacketLayout<message_header_type_t, message_id_t,
+	sensor_data_t, sensor_data_t, sensor_data_t, sensor_data_t> RotationPacket;
+typedef PacketLayout<message_header_type_t, message_id_t,
+	sensor_data_t, sensor_data_t, sensor_data_t, sensor_data_t, message_timestamp_t> RotationTimestampedPacket;
+typedef PacketLayout<message_header_type_t, message_id_t,
+	message_timestamp_t, message_timestamp_t, message_timestamp_t> ClockSyncPacket;
+
+// driver -> phone, little endian
+typedef PacketLayout<uint32_t, uint32_t, message_timestamp_t> HeartbeatPacket;
+typedef PacketLayout<uint32_t, float, float, float> BuzzPacket; // duration s, frequency, amplitude
+
+#define IN_ORDER ByteOrder::Big
+#define OUT_ORDER ByteOrder::Little
+
+static_assert(Vector3Packet::size == MSG_HEADER_SIZE + 12, "gyro/accel packet layout changed");
+static_assert(RotationPacket::size == MSG_HEADER_SIZE + 16, "rotation packet layout changed");
+static_assert(RotationTimestampedPacket::size == RotationPacket::size + 8, "timestamped rotation packet layout changed");
+static_assert(ClockSyncPacket::size == MSG_HEADER_SIZE + 24, "clock sync packet layout changed");
+static_assert(HeartbeatPacket::size == 16, "heartbeat packet layout changed");
+static_assert(BuzzPacket::size == 16, "buzz packet layout changed");
+static_assert(RotationTimestampedPacket::size <= MAX_MSG_SIZE, "packet doesn't fit the receive buffer");
 
 
 class NetworkedDeviceQuatServer : public DeviceQuatServer {
 private:
 	message_id_t current_packet_id = 0;
+	timestamp_us_t current_packet_time = 0;
+
+	// phone clock estimated from packet ids, see update_arrival_stats
+	double sender_clock_us = 0.0;
 
-	double* quat_buffer; // size 4
+	RotationSample rotation;
 	double* gyro_buffer; // size 3
 	double* accel_buffer; // size 3
 
 	bool receive_packet_id(message_id_t new_id);
+	void update_arrival_stats(message_id_t new_id);
 
 	bool isNewDataAvailable = false;
 
-	void handle_doubles_packet(unsigned char* packet, double* into, int num_doubles);
+	// rotation hasn't been handed out by isDataAvailable yet
+	bool isRotationPending = false;
+
+	bool use_jitter_buffer = false;
+	JitterBuffer jitter_buffer;
+
+	// whether the jitter buffer is currently fed phone timestamps or the id based estimate
+	bool jitter_buffer_synced = false;
+
+	ClockSync clock;
+
+	// samples not taken by popImuSample yet, oldest are overwritten
+	ImuSample imu_samples[MAX_IMU_SAMPLES];
+	int imu_first = 0;
+	int imu_count = 0;
+
+	void push_imu_sample();
+
+	bool handle_vector3_packet(const PacketReader<Vector3Packet, IN_ORDER>& r, double* into);
+	void accept_rotation(const double* quat, bool has_phone_time, message_timestamp_t phone_time);
 
 protected:
-	void handle_gyro_packet(unsigned char* packet);
-	void handle_accel_packet(unsigned char* packet);
-	void handle_rotation_packet(unsigned char* packet);
+	ServerStats stats;
+
+	// false if the packet is too short for its type, then nothing was read from it
+	bool handle_gyro_packet(const unsigned char* packet, size_t length);
+	bool handle_accel_packet(const unsigned char* packet, size_t length);
+	bool handle_rotation_packet(const unsigned char* packet, size_t length);
+	bool handle_timestamped_rotation_packet(const unsigned char* packet, size_t length);
+	bool handle_clock_sync_packet(const unsigned char* packet, size_t length);
 
 
 	char* buff_hello;
 	int buff_hello_len;
 
+	// driver time the packet being handled arrived at, from the kernel's receive
+	// timestamp where there is one, see UDPSocket::RecvFrom
+	timestamp_us_t packet_time = 0;
+
 public:
 	NetworkedDeviceQuatServer();
 
@@ -88,7 +158,18 @@ public:
 	double* getRotationQuaternion();
 	double* getGyroscope();
 	double* getAccel();
+	bool popImuSample(ImuSample& out);
+
+	timestamp_us_t getSampleTime();
+	timestamp_us_t getSensorTime();
+	const ServerStats& getStats();
+	const ClockSync& getClockSync();
+
+	void setJitterBufferEnabled(bool enabled);
+	double getJitterBufferDelay();
 };
 
-#define HEARTBEAT_THRESHOLD 1000
-#define DEAD_THRESHOLD HEARTBEAT_THRESHOLD*10
+// consecutive socket errors before backing off, and the backoff range
+#define SOCKET_ERROR_BACKOFF_THRESHOLD 4
+#define SOCKET_BACKOFF_MIN_MS 10
+#define SOCKET_BACKOFF_MAX_MS 1000
@@ -0,0 +1,45 @@
+#include "OneEuroFilter.h"
+
+#include <cmath>
+
+// cutoff of the speed estimate itself, fixed as in the paper
+#define SPEED_CUTOFF_HZ 1.0
+
+// weight of the new sample for a first order low pass at cutoff
+static double smoothing_alpha(double cutoff, double dt) {
+	double tau = 1.0 / (2.0 * Math_PI * cutoff);
+	return 1.0 / (1.0 + tau / dt);
+}
+
+Quat OneEuroFilter::filter(const Quat& rotation, timestamp_us_t time) {
+	Quat sample = rotation.normalized();
+
+	if (last_time == 0) {
+		filtered = sample;
+		last_time = time;
+		return filtered;
+	}
+
+	if (time <= last_time) return filtered;
+
+	double dt = (time - last_time) / 1000000.0;
+	last_time = time;
+
+	// angle between the last output and the new sample
+	double cos_half = std::abs(filtered.dot(sample));
+	double angle = 2.0 * std::acos((cos_half > 1.0) ? 1.0 : cos_half);
+
+	speed += (angle / dt - speed) * smoothing_alpha(SPEED_CUTOFF_HZ, dt);
+
+	double cutoff = min_cutoff + beta * speed;
+	if (cutoff < 0.01) cutoff = 0.01;
+	filtered = filtered.slerp(sample, smoothing_alpha(cutoff, dt)).normalized();
+
+	return filtered;
+}
+
+void OneEuroFilter::reset() {
+	filtered = Quat();
+	speed = 0.0;
+	last_time = 0;
+}
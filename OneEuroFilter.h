@@ -0,0 +1,22 @@
+#pragma once
+
+#include "quat.h"
+#include "timeutil.h"
+
+// One Euro filter (Casiez et al. 2012) on a rotation stream. the cutoff rises with
+// angular speed, so it smooths hard at rest and barely lags during fast motion
+class OneEuroFilter {
+private:
+	Quat filtered;
+	double speed = 0.0; // smoothed angular speed, rad/s
+	timestamp_us_t last_time = 0;
+
+public:
+	double min_cutoff = 1.0; // Hz, at rest
+	double beta = 0.5; // cutoff increase per rad/s
+
+	// time is when the sample was measured, samples with a time that didn't advance are ignored
+	Quat filter(const Quat& rotation, timestamp_us_t time);
+
+	void reset();
+};
@@ -0,0 +1,9 @@
+#include "OutboundQueue.h"
+
+char* OutboundQueue::reserve(int length) {
+	if ((count == MAX_MESSAGES) || (length > MAX_MESSAGE_SIZE))
+		return nullptr;
+
+	lengths[count] = length;
+	return slots[count++];
+}
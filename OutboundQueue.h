@@ -0,0 +1,24 @@
+#pragma once
+
+// fixed slots for messages to the phone, filled in place during the frame
+// and sent together by flush()
+class OutboundQueue {
+public:
+	static const int MAX_MESSAGES = 16;
+	static const int MAX_MESSAGE_SIZE = 64;
+
+private:
+	char slots[MAX_MESSAGES][MAX_MESSAGE_SIZE];
+	int lengths[MAX_MESSAGES];
+	int count = 0;
+
+public:
+	// returns a slot to serialize length bytes into, or nullptr if the queue is full
+	char* reserve(int length);
+
+	int size() const { return count; }
+	const char* get(int idx) const { return slots[idx]; }
+	int get_length(int idx) const { return lengths[idx]; }
+
+	void clear() { count = 0; }
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+// compile-time packet layouts, read and written in place with no allocation.
+// field types and offsets are fixed by the layout, so a wrong index or type doesn't compile
+
+enum class ByteOrder {
+	Little,
+	Big
+};
+
+namespace packet_detail {
+	// written out recursively, the Debug|x64 build is still C++14 and has no fold expressions
+	template<typename... Fields>
+	struct all_arithmetic : std::true_type {};
+	template<typename First, typename... Rest>
+	struct all_arithmetic<First, Rest...> : std::integral_constant<bool, std::is_arithmetic<First>::value && all_arithmetic<Rest...>::value> {};
+
+	template<typename... Fields>
+	struct total_size : std::integral_constant<size_t, 0> {};
+	template<typename First, typename... Rest>
+	struct total_size<First, Rest...> : std::integral_constant<size_t, sizeof(First) + total_size<Rest...>::value> {};
+}
+
+template<typename... Fields>
+struct PacketLayout {
+	static_assert(sizeof...(Fields) > 0, "empty packet");
+	static_assert(packet_detail::all_arithmetic<Fields...>::value, "packet fields must be plain numbers");
+
+	static constexpr size_t size = packet_detail::total_size<Fields...>::value;
+	static constexpr size_t num_fields = sizeof...(Fields);
+
+	template<size_t I>
+	using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+	template<size_t I>
+	static constexpr size_t offset() {
+		static_assert(I < num_fields, "field index out of range");
+		constexpr size_t sizes[] = { sizeof(Fields)... };
+		size_t total = 0;
+		for (size_t i = 0; i < I; i++) total += sizes[i];
+		return total;
+	}
+};
+
+template<typename... Fields>
+constexpr size_t PacketLayout<Fields...>::size;
+
+namespace packet_detail {
+	inline bool host_is_little() {
+		const uint16_t probe = 1;
+		return *(const uint8_t*)&probe == 1;
+	}
+
+	template<ByteOrder Order, typename T>
+	inline void store(uint8_t* at, T value) {
+		uint8_t raw[sizeof(T)];
+		memcpy(raw, &value, sizeof(T));
+
+		bool swap = (Order == ByteOrder::Little) != host_is_little();
+		for (size_t i = 0; i < sizeof(T); i++)
+			at[i] = swap ? raw[sizeof(T) - i - 1] : raw[i];
+	}
+
+	template<ByteOrder Order, typename T>
+	inline T load(const uint8_t* at) {
+		uint8_t raw[sizeof(T)];
+
+		bool swap = (Order == ByteOrder::Little) != host_is_little();
+		for (size_t i = 0; i < sizeof(T); i++)
+			raw[i] = swap ? at[sizeof(T) - i - 1] : at[i];
+
+		T value;
+		memcpy(&value, raw, sizeof(T));
+		return value;
+	}
+}
+
+// writes the fields of Layout into a caller-provided buffer of at least Layout::size bytes
+template<typename Layout, ByteOrder Order>
+class PacketWriter {
+private:
+	uint8_t* bytes;
+
+public:
+	static constexpr size_t size = Layout::size;
+
+	PacketWriter(void* into) : bytes((uint8_t*)into) {}
+
+	template<size_t I>
+	PacketWriter& set(typename Layout::template field_t<I> value) {
+		packet_detail::store<Order>(bytes + Layout::template offset<I>(), value);
+		return *this;
+	}
+};
+
+// reads the fields of Layout out of a received buffer. nothing may be read unless valid(),
+// a datagram shorter than the layout would leave the rest of the fields as whatever was there before
+template<typename Layout, ByteOrder Order>
+class PacketReader {
+private:
+	const uint8_t* bytes;
+	size_t length;
+
+public:
+	static constexpr size_t size = Layout::size;
+
+	PacketReader(const void* from, size_t received) : bytes((const uint8_t*)from), length(received) {}
+
+	// long enough for every field, anything past them is ignored
+	bool valid() const { return length >= Layout::size; }
+
+	template<size_t I>
+	typename Layout::template field_t<I> get() const {
+		return packet_detail::load<Order, typename Layout::template field_t<I>>(bytes + Layout::template offset<I>());
+	}
+};
+
+template<typename Layout, ByteOrder Order>
+constexpr size_t PacketWriter<Layout, Order>::size;
+
+template<typename Layout, ByteOrder Order>
+constexpr size_t PacketReader<Layout, Order>::size;
@@ -1,35 +1,62 @@
 #include "PositionPredictor.h"
 
+#include <cmath>
+
 #define MINIMI_RES 0.12
 
-inline double minimize_val(double v) {
-	return (abs(v) < MINIMI_RES) ? 0 : v - MINIMI_RES;
+// the filter constants were tuned per sample at 90 samples a second,
+// they're scaled by how much time each sample actually covers
+#define REFERENCE_DT (1.0 / 90.0)
+
+// longer gaps are treated as this, so a stall doesn't fling the position
+#define MAX_DT 0.1
+
+inline double minimize_val(double v, double amount) {
+	if (std::abs(v) < amount) return 0;
+	return (v > 0) ? v - amount : v + amount;
 }
 
-inline Vector3 minimize_vector(Vector3 v) {
+inline Vector3 minimize_vector(Vector3 v, double amount) {
 	return Vector3(
-		minimize_val(v.x),
-		minimize_val(v.y),
-		minimize_val(v.z)
+		minimize_val(v.x, amount),
+		minimize_val(v.y, amount),
+		minimize_val(v.z, amount)
 	);
 }
 
+// lerp weight that has the same effect over dt as per_step has over REFERENCE_DT
+inline double lerp_weight(double per_step, double steps) {
+	return 1.0 - std::pow(1.0 - per_step, steps);
+}
+
+
+void PositionPredictor::add_sample(const ImuSample& sample, const Basis& basis){
+	if (last_sample_time == 0) {
+		last_sample_time = sample.time;
+		return;
+	}
 
+	double dt = (sample.time > last_sample_time) ? (sample.time - last_sample_time) / 1000000.0 : 0.0;
+	last_sample_time = sample.time;
+	if (dt > MAX_DT) dt = MAX_DT;
 
-Vector3 PositionPredictor::predict(DeviceQuatServer& serv, Basis& basis){
-	double *gyro_a = serv.getGyroscope();
-	double *accel_a = serv.getAccel();
-	gyro = gyro.lerp(Vector3(gyro_a[0], gyro_a[1], gyro_a[2]), 0.1);
-	acceleration = acceleration.lerp(Vector3(accel_a[0], accel_a[1], accel_a[2]), 0.4);
+	double steps = dt / REFERENCE_DT;
 
+	gyro = gyro.lerp(Vector3(sample.gyro[0], sample.gyro[1], sample.gyro[2]), lerp_weight(0.1, steps));
+	acceleration = acceleration.lerp(Vector3(sample.accel[0], sample.accel[1], sample.accel[2]), lerp_weight(0.4, steps));
+
+	// deadzone on the reading itself, not a rate
 	Vector3 accel_local = acceleration / (1.0 + gyro.length_squared() * 4.0);
-	accel_local = minimize_vector(accel_local);
+	accel_local = minimize_vector(accel_local, MINIMI_RES);
 
-	velocity += basis.xform(accel_local);
-	velocity = minimize_vector(velocity);
-	velocity /= 1.12;
+	velocity += basis.xform(accel_local) * steps;
+	velocity = minimize_vector(velocity, MINIMI_RES * steps);
+	velocity *= std::pow(1.0 / 1.12, steps);
 
-	position = position.lerp((position + velocity * 3.0) / 1.6, 0.05);
+	// lerp(position, (position + velocity * 3.0) / 1.6, 0.05) per step, split into decay and gain
+	position = position * std::pow(1.0 - 0.05 * (1.0 - 1.0 / 1.6), steps) + velocity * (0.05 * 3.0 / 1.6) * steps;
+}
 
+Vector3 PositionPredictor::get_offset(){
 	return position / 100.0;
 }
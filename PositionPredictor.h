@@ -11,6 +11,11 @@ private:
 	Vector3 velocity = Vector3();
 	Vector3 acceleration = Vector3();
 
+	timestamp_us_t last_sample_time = 0;
+
 public:
-	Vector3 predict(DeviceQuatServer& serv, Basis& basis);
-};
\ No newline at end of file
+	// integrates one IMU sample, basis is the tracker's current orientation
+	void add_sample(const ImuSample& sample, const Basis& basis);
+
+	Vector3 get_offset();
+};
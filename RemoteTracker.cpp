@@ -11,19 +11,21 @@
 #include "quaternion.h"
 #include "basis.h"
 
-// TODO for convert_chars
-#include "NetworkedDeviceQuatServer.h"
-
 using namespace vr;
 
-RemoteTracker::RemoteTracker(DeviceQuatServer *server, const int& id_v, RemoteTrackerSettings settings_v) : dataserver(server), settings(settings_v), id(id_v) {
+// horizontal anchor speed that counts as walking for the yaw drift correction, m/s
+#define WALKING_SPEED 0.3
+
+RemoteTracker::RemoteTracker(DeviceQuatServer *server, const int& id_v, RemoteTrackerSettings settings_v, EventRouter& router) : events(router), settings(settings_v), dataserver(server), id(id_v), serial_index(id_v) {
 	m_unObjectId = vr::k_unTrackedDeviceIndexInvalid;
 	m_ulPropertyContainer = vr::k_ulInvalidPropertyContainer;
 
-	m_sSerialNumber = "OWO_TRACKER_" + std::to_string(id);
-	m_sModelNumber = "OwoTracker_" + std::to_string(id);
+	m_sSerialNumber = "OWO_TRACKER_" + std::to_string(serial_index);
+	m_sModelNumber = "OwoTracker_" + std::to_string(serial_index);
 
 	port_no = dataserver->get_port();
+
+	dataserver->setJitterBufferEnabled(settings.use_jitter_buffer);
 }
 
 RemoteTracker::~RemoteTracker()
@@ -73,25 +75,36 @@ EVRInitError RemoteTracker::Activate(vr::TrackedDeviceIndex_t unObjectId)
 	vr::VRDriverInput()->CreateHapticComponent(m_ulPropertyContainer, "/output/haptic", &haptic);
 
 
+	activated = true;
+
+	// destroyed before SteamVR got to activating it, rebind starts listening once it's reused
+	if (!dataserver) return VRInitError_None;
+
 	try {
 		dataserver->startListening();
 	}
 	catch (std::system_error& e) {
-		DriverLog("*** LISTEN FAILED ***");
-		DriverLog(e.what());
+		DRIVER_LOG("*** LISTEN FAILED *** %s", e.what());
+		activated = false;
 		return VRInitError_Driver_Failed;
 	}
 
-	activated = true;
+	register_events();
 
 	return VRInitError_None;
 }
 
 void RemoteTracker::Deactivate()
 {
+	events.remove(this);
 	m_unObjectId = vr::k_unTrackedDeviceIndexInvalid;
 }
 
+void RemoteTracker::register_events() {
+	events.add_device(m_unObjectId, this);
+	events.add_haptic(haptic, this);
+}
+
 void RemoteTracker::EnterStandby(){}
 
 void* RemoteTracker::GetComponent(const char* pchComponentNameAndVersion)
@@ -133,6 +146,65 @@ void RemoteTracker::send_invalid_pose() {
 }
 
 
+void RemoteTracker::unbind() {
+	send_invalid_pose();
+	events.remove(this);
+
+	if (associated_controller)
+		associated_controller->enabled = false;
+
+	delete dataserver;
+	dataserver = nullptr;
+	port_no = 0;
+}
+
+bool RemoteTracker::rebind(DeviceQuatServer* server, RemoteTrackerSettings settings_v) {
+	dataserver = server;
+	settings = settings_v;
+	port_no = dataserver->get_port();
+
+	// nothing carries over from whoever used this device before
+	pos_predict = PositionPredictor();
+	rotation_filter.reset();
+	fusion.reset();
+	gyro_bias.reset();
+	yaw_drift.reset();
+	haptics = HapticScheduler();
+	latency = LatencyStats();
+	last_published_sample = 0;
+	is_calibrating = false;
+	is_down_calibrating = false;
+	was_calibrating = false;
+	was_down_calibrating = false;
+	calibration.reset_yaw();
+	calibration.reset_down();
+
+	dataserver->setJitterBufferEnabled(settings.use_jitter_buffer);
+
+	// otherwise Activate starts listening
+	if (!activated) return true;
+
+	try {
+		dataserver->startListening();
+	}
+	catch (std::system_error& e) {
+		DRIVER_LOG("*** LISTEN FAILED *** %s", e.what());
+		return false;
+	}
+
+	register_events();
+	return true;
+}
+
+void RemoteTracker::flush_network() {
+	float duration, frequency, amplitude;
+	if (haptics.poll(get_time_us(), duration, frequency, amplitude))
+		dataserver->buzz(duration, frequency, amplitude);
+
+	dataserver->flush();
+}
+
+
 template<typename T>
 inline owoEvent RemoteTracker::give_value(T local_val, owoEvent ev) {
 	owoEvent ret_event = {};
@@ -210,6 +282,68 @@ owoEvent RemoteTracker::process_request(owoEvent ev){
 			return set_setting_or_give_value(is_down_calibrating, ev);
 		case IS_CONN_ALIVE: 
 			return give_value(dataserver->isConnectionAlive(), ev);
+		case CONN_STATE:
+			return give_value((unsigned int)dataserver->getConnectionState(), ev);
+		case HAPTIC_STATS:
+			return give_value(owoEventVector{ (double)haptics.get_requests(), (double)haptics.get_commands(), 0.0 }, ev);
+		case NET_SEND_STATS: {
+			const ServerStats& stats = dataserver->getStats();
+			double per_call = (stats.send_calls > 0) ? ((double)stats.messages_sent / stats.send_calls) : 0.0;
+			return give_value(owoEventVector{ (double)stats.messages_sent, (double)stats.send_calls, per_call }, ev);
+		}
+		case LATENCY_STATS:
+			return give_value(owoEventVector{ latency.get_percentile(0.5), latency.get_percentile(0.99), latency.get_max() }, ev);
+		case SAMPLES_OVERWRITTEN:
+			return give_value(dataserver->getStats().samples_overwritten, ev);
+		case NET_PACKET_COUNTERS: {
+			const ServerStats& stats = dataserver->getStats();
+			return give_value(owoEventVector{ (double)stats.packets_lost, (double)stats.packets_reordered, (double)stats.packets_duplicate }, ev);
+		}
+		case SOCKET_ERRORS:
+			return give_value(dataserver->getStats().socket_errors, ev);
+		case NET_STREAM_RESETS:
+			return give_value(dataserver->getStats().stream_resets, ev);
+		case NET_JITTER:
+			return give_value(dataserver->getStats().jitter_us / 1000.0, ev);
+		case NET_PACKET_RATE:
+			return give_value(dataserver->getStats().get_packet_rate(), ev);
+		case JITTER_BUFFER: {
+			owoEvent result = set_setting_or_give_value(settings.use_jitter_buffer, ev);
+			dataserver->setJitterBufferEnabled(settings.use_jitter_buffer);
+			return result;
+		}
+		case CALIBRATION_RESIDUAL:
+			return give_value(owoEventVector{ calibration.get_yaw_residual() * 180.0 / Math_PI, calibration.get_down_residual() * 180.0 / Math_PI, (double)calibration.get_samples() }, ev);
+		case GYRO_BIAS: {
+			const Vector3& bias = gyro_bias.get_bias();
+			return give_value(owoEventVector{ bias.x, bias.y, bias.z }, ev);
+		}
+		case ONBOARD_FUSION: {
+			owoEvent result = set_setting_or_give_value(settings.use_onboard_fusion, ev);
+			fusion.reset();
+			return result;
+		}
+		case YAW_DRIFT_CORRECTION: {
+			owoEvent result = set_setting_or_give_value(settings.use_yaw_drift_correction, ev);
+			yaw_drift.reset();
+			return result;
+		}
+		case SMOOTHING: {
+			owoEvent result = set_setting_or_give_value(settings.use_smoothing, ev);
+			// start over from the next sample instead of easing in from a stale rotation
+			rotation_filter.reset();
+			return result;
+		}
+		case SMOOTHING_MIN_CUTOFF:
+			return set_setting_or_give_value(settings.smoothing_min_cutoff, ev);
+		case SMOOTHING_BETA:
+			return set_setting_or_give_value(settings.smoothing_beta, ev);
+		case JITTER_BUFFER_DELAY:
+			return give_value(dataserver->getJitterBufferDelay(), ev);
+		case CLOCK_SYNC: {
+			const ClockSync& clock = dataserver->getClockSync();
+			return give_value(owoEventVector{ clock.get_offset_us() / 1000.0, clock.get_drift_ppm(), clock.get_rtt_us() / 1000.0 }, ev);
+		}
 		case OFFSET_GLOBAL:
 			return handle_vector(settings.offset_global, ev);
 		case OFFSET_LOCAL_TO_DEVICE:
@@ -233,20 +367,49 @@ std::string RemoteTracker::get_description() {
 	return "Tracker " + std::to_string(id);
 }
 
-const Basis& RemoteTracker::get_last_basis() {
-	return last_basis;
+const RemoteTrackerSettings& RemoteTracker::get_settings() const {
+	return settings;
 }
 
+TrackerSnapshot RemoteTracker::take_snapshot() {
+	TrackerSnapshot snapshot;
+	snapshot.taken_at = get_wall_time_us();
+
+	if (dataserver)
+		snapshot.connection = dataserver->getConnectionSnapshot();
 
-void RemoteTracker::update_pose_if_needed(TrackedDevicePose_t* poses) {
+	const Vector3& bias = gyro_bias.get_bias();
+	for (int i = 0; i < 3; i++)
+		snapshot.gyro_bias[i] = bias[i];
+
+	return snapshot;
+}
+
+void RemoteTracker::resume(const TrackerSnapshot& snapshot) {
+	gyro_bias.restore(Vector3(snapshot.gyro_bias[0], snapshot.gyro_bias[1], snapshot.gyro_bias[2]));
+
+	// bind now rather than when SteamVR gets around to activating us,
+	// the phone is still sending and expects a heartbeat soon
 	try {
-		dataserver->tick();
+		dataserver->startListening();
 	}
 	catch (std::system_error& e) {
-		DriverLog("*** TICK FAILED ***");
-		DriverLog(e.what());
+		DRIVER_LOG("*** LISTEN FAILED *** %s", e.what());
+		return;
 	}
 
+	dataserver->resumeConnection(snapshot.connection);
+}
+
+const Basis& RemoteTracker::get_last_basis() {
+	return last_basis;
+}
+
+
+void RemoteTracker::update_pose_if_needed(AnchorCache& anchors) {
+	// doesn't throw, socket errors are handled and logged by the server itself
+	dataserver->tick();
+
 	if (!dataserver->isDataAvailable()) {
 		if (!dataserver->isConnectionAlive()) {
 			send_invalid_pose();
@@ -266,23 +429,13 @@ void RemoteTracker::update_pose_if_needed(TrackedDevicePose_t* poses) {
 	Vector3 offset_local_tracker = settings.offset_local_tracker;
 
 
-	if ((settings.anchor_device_id >= 0) && (poses)) {
-		TrackedDevicePose_t anchor = poses[settings.anchor_device_id];
+	const AnchorPose* anchor = anchors.get(settings.anchor_device_id);
+	if (anchor) {
 		for (int i = 0; i < 3; i++) {
-			pose.vecPosition[i] = anchor.mDeviceToAbsoluteTracking.m[i][3];
+			pose.vecPosition[i] = anchor->position.get_axis(i);
 		}
 
-		offset_basis.set(
-			anchor.mDeviceToAbsoluteTracking.m[0][0],
-			anchor.mDeviceToAbsoluteTracking.m[0][1],
-			anchor.mDeviceToAbsoluteTracking.m[0][2],
-			anchor.mDeviceToAbsoluteTracking.m[1][0],
-			anchor.mDeviceToAbsoluteTracking.m[1][1],
-			anchor.mDeviceToAbsoluteTracking.m[1][2],
-			anchor.mDeviceToAbsoluteTracking.m[2][0],
-			anchor.mDeviceToAbsoluteTracking.m[2][1],
-			anchor.mDeviceToAbsoluteTracking.m[2][2]
-		);
+		offset_basis = anchor->basis;
 	}
 	else {
 		offset_basis.set_euler(Vector3());
@@ -308,34 +461,85 @@ void RemoteTracker::update_pose_if_needed(TrackedDevicePose_t* poses) {
 	pose.qWorldFromDriverRotation = quaternion::init(0, 0, 0, 1);
 	pose.qDriverFromHeadRotation = quaternion::init(0, 0, 0, 1);
 
+	// every gyro/accel sample since the last frame, not just the newest
+	ImuSample imu_samples[MAX_IMU_SAMPLES];
+	int imu_count = 0;
+	while ((imu_count < MAX_IMU_SAMPLES) && dataserver->popImuSample(imu_samples[imu_count])) {
+		imu_count++;
+	}
+
+	// everything downstream gets the bias corrected gyro
+	for (int i = 0; i < imu_count; i++) {
+		gyro_bias.add_sample(imu_samples[i]);
+
+		const Vector3& bias = gyro_bias.get_bias();
+		for (int j = 0; j < 3; j++) {
+			imu_samples[i].gyro[j] -= bias.get_axis(j);
+		}
+	}
+
 	double* rotation = dataserver->getRotationQuaternion();
 
 	Quat quat = Quat(rotation[0], rotation[1], rotation[2], rotation[3]);
 
+	if (settings.use_onboard_fusion) {
+		fusion.set_reference(quat);
+		for (int i = 0; i < imu_count; i++) {
+			fusion.add_sample(imu_samples[i]);
+		}
+
+		if (fusion.is_ready())
+			quat = fusion.get_rotation();
+	}
+
+	if (settings.use_smoothing) {
+		rotation_filter.min_cutoff = settings.smoothing_min_cutoff;
+		rotation_filter.beta = settings.smoothing_beta;
+		quat = rotation_filter.filter(quat, dataserver->getSensorTime());
+	}
+
 	quat = Quat(Vector3(1, 0, 0), -Math_PI / 2.0) * quat;
 
+	if (is_calibrating && !was_calibrating)
+		calibration.reset_yaw();
+	was_calibrating = is_calibrating;
+
 	if (is_calibrating) {
-		settings.global_rot_euler = Vector3(0, (get_yaw(quat)) - (get_yaw(offset_basis, Vector3(0, 0, -1))), 0);
+		double anchor_yaw = anchor ? anchor->yaw : get_yaw(offset_basis, Vector3(0, 0, -1));
+		settings.global_rot_euler = Vector3(0, calibration.add_yaw(get_yaw(quat) - anchor_yaw, get_time_us()), 0);
 
 		offset_global = (offset_basis.xform(Vector3(0, 0, -1)) * Vector3(1, 0, 1)).normalized() + Vector3(0, 0.2, 0);
 		offset_local_device = Vector3(0, 0, 0);
 		offset_local_tracker = Vector3(0, 0, 0);
+
+		// the new offset starts with a clean slate
+		yaw_drift.reset();
+	}
+	else if (settings.use_yaw_drift_correction && anchor && !is_down_calibrating) {
+		Vector3 anchor_velocity = anchor->velocity;
+		bool walking = (anchor_velocity.x * anchor_velocity.x + anchor_velocity.z * anchor_velocity.z) > (WALKING_SPEED * WALKING_SPEED);
+
+		// the raw phone's heading means nothing once it's strapped on sideways, but down
+		// calibration lines the finished tracker's front (+Z) up with the anchor's yaw
+		Quat calibrated = Quat(settings.global_rot_euler) * quat * Quat(settings.local_rot_euler);
+		double error = wrap_angle(get_yaw(Basis(calibrated), Vector3(0, 0, 1)) - anchor->yaw);
+
+		settings.global_rot_euler.y += yaw_drift.update(error, walking, get_time_us());
 	}
 
 	quat = Quat(settings.global_rot_euler) * quat;
 
 
+	if (is_down_calibrating && !was_down_calibrating)
+		calibration.reset_down();
+	was_down_calibrating = is_down_calibrating;
+
 	if (is_down_calibrating) {
-		float anchor_yaw = 0.0;
-		if ((settings.anchor_device_id >= 0) && (poses)) {
-			auto matrix = poses[settings.anchor_device_id].mDeviceToAbsoluteTracking;
-			anchor_yaw = 
-				get_yaw(from_hmdMatrix(matrix), Vector3(0, 0, -1));
-		}
-		
+		float anchor_yaw = anchor ? anchor->yaw : 0.0;
+
 		auto rot = quat.inverse().get_euler_yxz();
-		rot = (Quat(rot) * Quat(Vector3(0, 1, 0), -anchor_yaw)).get_euler_yxz();
-		settings.local_rot_euler = rot;
+		Quat sample = Quat(rot) * Quat(Vector3(0, 1, 0), -anchor_yaw);
+		settings.local_rot_euler = calibration.add_down(sample, get_time_us()).get_euler_yxz();
 	}
 
 	quat = quat * Quat(settings.local_rot_euler);
@@ -359,8 +563,11 @@ void RemoteTracker::update_pose_if_needed(TrackedDevicePose_t* poses) {
 
 
 	if ((!is_calibrating) && settings.should_predict_position) {
-		Basis b = Basis(quat);
-		Vector3 result = pos_predict.predict(*dataserver, b) * settings.position_prediction_strength;
+		for (int i = 0; i < imu_count; i++) {
+			pos_predict.add_sample(imu_samples[i], final_tracker_basis);
+		}
+
+		Vector3 result = pos_predict.get_offset() * settings.position_prediction_strength;
 
 		pose.vecPosition[0] += result.x;
 		pose.vecPosition[1] += result.y;
@@ -368,27 +575,43 @@ void RemoteTracker::update_pose_if_needed(TrackedDevicePose_t* poses) {
 	}
 
 	VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, pose, sizeof(pose));
+
+	// isDataAvailable is also true for gyro/accel only updates, only count fresh rotations
+	timestamp_us_t sample_time = dataserver->getSampleTime();
+	if (sample_time != last_published_sample) {
+		latency.add(get_time_us() - sample_time);
+		last_published_sample = sample_time;
+	}
 }
 
-void RemoteTracker::RunFrame(TrackedDevicePose_t* poses) {
+void RemoteTracker::RunFrame(AnchorCache& anchors) {
 	if (!activated) return;
 
-	update_pose_if_needed(poses);
+	update_pose_if_needed(anchors);
 	if (associated_controller) {
-		associated_controller->RunFrame(poses);
+		associated_controller->RunFrame(anchors);
 	}
 }
 
+int RemoteTracker::get_highest_anchor() {
+	int highest = settings.anchor_device_id;
+
+	// hip movement is relative to the headset
+	if (associated_controller && associated_controller->enabled && (highest < 0))
+		highest = 0;
+
+	return highest;
+}
+
 void RemoteTracker::ProcessEvent(const vr::VREvent_t& vrEvent)
 {
 	switch (vrEvent.eventType)
 	{
 	case vr::VREvent_Input_HapticVibration:
 	{
-		if (vrEvent.data.hapticVibration.componentHandle == haptic)
-		{
-			dataserver->buzz(vrEvent.data.hapticVibration.fDurationSeconds, vrEvent.data.hapticVibration.fFrequency, vrEvent.data.hapticVibration.fAmplitude);
-		}
+		// the router only hands us vibrations for our own component,
+		// sent from flush_network, merged with everything else this frame
+		haptics.request(get_time_us(), vrEvent.data.hapticVibration.fDurationSeconds, vrEvent.data.hapticVibration.fFrequency, vrEvent.data.hapticVibration.fAmplitude);
 	}
 	break;
 	}
@@ -8,26 +8,50 @@
 
 #include "DeviceQuatServer.h"
 #include "RemoteTrackerSettings.h"
+#include "TrackerSnapshot.h"
 
 #include "PositionPredictor.h"
+#include "OneEuroFilter.h"
+#include "SensorFusion.h"
+#include "GyroBiasEstimator.h"
+#include "YawDriftCorrector.h"
+#include "CalibrationSolver.h"
+#include "LatencyStats.h"
+#include "HapticScheduler.h"
 
 #include "owoIPC.h"
 
 #include "AbstractDevice.h"
 
 #include "HipMoveController.h"
+#include "EventRouter.h"
 
 class RemoteTracker : public AbstractDevice {
 	private:
-		vr::VRInputComponentHandle_t haptic;
+		vr::VRInputComponentHandle_t haptic = vr::k_ulInvalidInputComponentHandle;
+		EventRouter& events;
+		void register_events();
+		HapticScheduler haptics;
 
 		RemoteTrackerSettings settings;
 		DeviceQuatServer* dataserver;
 		PositionPredictor pos_predict;
+		OneEuroFilter rotation_filter;
+		SensorFusion fusion;
+		GyroBiasEstimator gyro_bias;
+		YawDriftCorrector yaw_drift;
+
+		LatencyStats latency;
+		timestamp_us_t last_published_sample = 0;
 
 		bool is_calibrating = false;
 		bool is_down_calibrating = false;
 
+		// solver state starts over whenever a calibration is started
+		CalibrationSolver calibration;
+		bool was_calibrating = false;
+		bool was_down_calibrating = false;
+
 		Basis last_basis;
 
 		HipMoveController* associated_controller = 0;
@@ -42,15 +66,16 @@ class RemoteTracker : public AbstractDevice {
 
 		owoEvent handle_vector(Vector3& local_val, owoEvent ev);
 
-		void update_pose_if_needed(TrackedDevicePose_t* poses);
+		void update_pose_if_needed(AnchorCache& anchors);
 
 		bool activated = false;
 
 	public:
-		unsigned int id = 0;
+		unsigned int id = 0; // handle in the driver's tracker slot map
 		unsigned int port_no = 0;
+		unsigned int serial_index = 0; // numbers the serial, stays with the device across rebinds
 
-		RemoteTracker(DeviceQuatServer* server, const int& id, RemoteTrackerSettings settings_v);
+		RemoteTracker(DeviceQuatServer* server, const int& id, RemoteTrackerSettings settings_v, EventRouter& router);
 		~RemoteTracker();
 
 		EVRInitError Activate(vr::TrackedDeviceIndex_t unObjectId) override;
@@ -67,7 +92,10 @@ class RemoteTracker : public AbstractDevice {
 
 		DriverPose_t GetPose() override;
 
-		void RunFrame(TrackedDevicePose_t *poses) override;
+		void RunFrame(AnchorCache& anchors) override;
+
+		// highest device index this tracker needs a pose of, -1 for none
+		int get_highest_anchor();
 
 		void ProcessEvent(const vr::VREvent_t& vrEvent) override;
 
@@ -76,6 +104,19 @@ class RemoteTracker : public AbstractDevice {
 		const char* GetId() const override;
 
 		void send_invalid_pose();
+
+		// SteamVR can't remove a device, so a destroyed tracker drops its server
+		// (freeing the port) and waits to be handed a new one
+		void unbind();
+		bool rebind(DeviceQuatServer* server, RemoteTrackerSettings settings_v);
+
+		const RemoteTrackerSettings& get_settings() const;
+
+		// for picking up where the last run left off, see DeviceProvider::restore_trackers
+		TrackerSnapshot take_snapshot();
+		void resume(const TrackerSnapshot& snapshot);
+
+		void flush_network();
 		owoEvent process_request(owoEvent ev);
 		std::string get_description();
 
@@ -39,4 +39,18 @@ struct RemoteTrackerSettings {
 	// predict position?
 	bool should_predict_position = true;
 	double position_prediction_strength = 1.0;
+
+	// delay rotation samples by a few ms to release them at a steady rate
+	bool use_jitter_buffer = false;
+
+	// fuse the raw gyro/accel in the driver instead of using the phone's rotation directly
+	bool use_onboard_fusion = false;
+
+	// slowly follow the phone's yaw drift while walking, see YawDriftCorrector
+	bool use_yaw_drift_correction = false;
+
+	// One Euro smoothing of the rotation
+	bool use_smoothing = false;
+	double smoothing_min_cutoff = 1.0; // Hz
+	double smoothing_beta = 0.5;
 };
@@ -0,0 +1,74 @@
+#include "SensorFusion.h"
+
+#include <cmath>
+
+#define GRAVITY 9.80665
+
+// accelerometer readings further than this from 1 g are mostly motion, not gravity
+#define ACCEL_TRUST_RANGE 1.0
+
+// rad/s of correction per unit of error
+#define ACCEL_GAIN 1.0
+#define REFERENCE_GAIN 0.5
+
+// longer gaps aren't integrated, the reference pulls it back instead
+#define MAX_DT 0.1
+
+void SensorFusion::set_reference(const Quat& phone_rotation) {
+	reference = phone_rotation.normalized();
+	has_reference = true;
+}
+
+void SensorFusion::add_sample(const ImuSample& sample) {
+	if (!initialized) {
+		if (!has_reference) return;
+
+		rotation = reference;
+		last_time = sample.time;
+		initialized = true;
+		return;
+	}
+
+	if (sample.time <= last_time) return;
+	double dt = (sample.time - last_time) / 1000000.0;
+	last_time = sample.time;
+	if (dt > MAX_DT) dt = MAX_DT;
+
+	Vector3 gyro = Vector3(sample.gyro[0], sample.gyro[1], sample.gyro[2]);
+	Vector3 accel = Vector3(sample.accel[0], sample.accel[1], sample.accel[2]);
+
+	// world up (z) in the phone's frame, which is what the accelerometer reads at rest
+	Vector3 up = rotation.xform_inv(Vector3(0, 0, 1));
+
+	Vector3 error;
+
+	double accel_length = accel.length();
+	bool accel_usable = std::abs(accel_length - GRAVITY) < ACCEL_TRUST_RANGE;
+	if (accel_usable)
+		error += (accel / accel_length).cross(up) * ACCEL_GAIN;
+
+	if (has_reference) {
+		// small angle rotation from ours to the phone's, in the phone's frame
+		Quat diff = rotation.inverse() * reference;
+		if (diff.w < 0) diff = -diff;
+		Vector3 reference_error = Vector3(diff.x, diff.y, diff.z) * 2.0;
+
+		// the accelerometer already has tilt covered
+		if (accel_usable)
+			reference_error = up * reference_error.dot(up);
+
+		error += reference_error * REFERENCE_GAIN;
+	}
+
+	Vector3 omega = gyro + error;
+	double speed = omega.length();
+	if (speed * dt > 1e-9)
+		rotation = (rotation * Quat(omega / speed, speed * dt)).normalized();
+}
+
+void SensorFusion::reset() {
+	rotation = Quat();
+	initialized = false;
+	last_time = 0;
+	has_reference = false;
+}
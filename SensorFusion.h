@@ -0,0 +1,31 @@
+#pragma once
+
+#include "quat.h"
+#include "vector3.h"
+#include "DeviceQuatServer.h"
+
+// Mahony style complementary filter on the raw gyro and accelerometer.
+// the gyro is integrated at full packet rate, the accelerometer corrects tilt whenever it
+// reads about 1 g, and the phone's own (slower) fused rotation is only a slow reference,
+// for yaw, or for everything while the accelerometer can't be trusted
+class SensorFusion {
+private:
+	Quat rotation;
+	bool initialized = false;
+	timestamp_us_t last_time = 0;
+
+	Quat reference;
+	bool has_reference = false;
+
+public:
+	// latest rotation from the phone, same frame as the output
+	void set_reference(const Quat& phone_rotation);
+
+	void add_sample(const ImuSample& sample);
+
+	// false until the first reference arrived
+	bool is_ready() const { return initialized; }
+	const Quat& get_rotation() const { return rotation; }
+
+	void reset();
+};
@@ -0,0 +1,341 @@
+#include "SettingsStore.h"
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <windows.h>
+
+#include "driverlog.h"
+#include "crc32.h"
+
+#define SETTINGS_STORE_MAGIC 0x534F574F // "OWOS"
+#define SETTINGS_STORE_VERSION 2
+
+// fixed layout on disk, RemoteTrackerSettings can change without breaking old files
+// as long as fields are only appended here and the version is bumped
+struct StoredSettings {
+	double offset_global[3];
+	double offset_local_device[3];
+	double offset_local_tracker[3];
+	double global_rot_euler[3];
+	double local_rot_euler[3];
+	double yaw_offset;
+	double override_to[3];
+	double position_prediction_strength;
+	double smoothing_min_cutoff;
+	double smoothing_beta;
+	uint32_t anchor_device_id;
+	uint8_t override_enabled[3];
+	uint8_t should_predict_position;
+	uint8_t use_jitter_buffer;
+	uint8_t use_onboard_fusion;
+	uint8_t use_yaw_drift_correction;
+	uint8_t use_smoothing;
+	uint8_t reserved[4];
+};
+static_assert(sizeof(StoredSettings) == 192, "settings store layout changed");
+
+struct StoredSnapshot {
+	uint64_t taken_at;
+	uint32_t client_addr;
+	uint16_t client_port;
+	uint16_t connection_state;
+	double gyro_bias[3];
+	uint32_t crc; // of the fields above, 0 if there's no snapshot
+	uint32_t reserved;
+};
+static_assert(sizeof(StoredSnapshot) == 48, "settings store layout changed");
+
+struct StoreHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t record_count;
+	uint32_t crc; // of the fields above
+	uint32_t reserved[3];
+};
+static_assert(sizeof(StoreHeader) == 32, "settings store layout changed");
+
+struct SettingsStore::Record {
+	char serial[STORED_SERIAL_LEN]; // empty when the slot is free
+	uint32_t serial_index;
+	int32_t port;
+	StoredSettings settings;
+	uint32_t crc; // of everything above
+	uint32_t reserved;
+
+	// rewritten every sync, so it's checked on its own
+	StoredSnapshot snapshot;
+};
+static_assert(sizeof(SettingsStore::Record) == 288, "settings store layout changed");
+
+#define STORE_FILE_SIZE (sizeof(StoreHeader) + MAX_STORED_TRACKERS * sizeof(SettingsStore::Record))
+
+static void copy_vector(double* to, const Vector3& from) {
+	to[0] = from.x;
+	to[1] = from.y;
+	to[2] = from.z;
+}
+
+static StoredSettings to_stored(const RemoteTrackerSettings& s) {
+	StoredSettings r;
+	memset(&r, 0, sizeof(r)); // padding too, records are compared bytewise
+
+	copy_vector(r.offset_global, s.offset_global);
+	copy_vector(r.offset_local_device, s.offset_local_device);
+	copy_vector(r.offset_local_tracker, s.offset_local_tracker);
+	copy_vector(r.global_rot_euler, s.global_rot_euler);
+	copy_vector(r.local_rot_euler, s.local_rot_euler);
+	r.yaw_offset = s.yaw_offset;
+
+	r.override_enabled[0] = s.x_override.enabled;
+	r.override_enabled[1] = s.y_override.enabled;
+	r.override_enabled[2] = s.z_override.enabled;
+	r.override_to[0] = s.x_override.to;
+	r.override_to[1] = s.y_override.to;
+	r.override_to[2] = s.z_override.to;
+
+	r.anchor_device_id = s.anchor_device_id;
+	r.should_predict_position = s.should_predict_position;
+	r.position_prediction_strength = s.position_prediction_strength;
+	r.use_jitter_buffer = s.use_jitter_buffer;
+	r.use_onboard_fusion = s.use_onboard_fusion;
+	r.use_yaw_drift_correction = s.use_yaw_drift_correction;
+	r.use_smoothing = s.use_smoothing;
+	r.smoothing_min_cutoff = s.smoothing_min_cutoff;
+	r.smoothing_beta = s.smoothing_beta;
+
+	return r;
+}
+
+static RemoteTrackerSettings from_stored(const StoredSettings& r) {
+	RemoteTrackerSettings s;
+
+	s.offset_global = Vector3(r.offset_global[0], r.offset_global[1], r.offset_global[2]);
+	s.offset_local_device = Vector3(r.offset_local_device[0], r.offset_local_device[1], r.offset_local_device[2]);
+	s.offset_local_tracker = Vector3(r.offset_local_tracker[0], r.offset_local_tracker[1], r.offset_local_tracker[2]);
+	s.global_rot_euler = Vector3(r.global_rot_euler[0], r.global_rot_euler[1], r.global_rot_euler[2]);
+	s.local_rot_euler = Vector3(r.local_rot_euler[0], r.local_rot_euler[1], r.local_rot_euler[2]);
+	s.yaw_offset = r.yaw_offset;
+
+	s.x_override = { r.override_enabled[0] != 0, r.override_to[0] };
+	s.y_override = { r.override_enabled[1] != 0, r.override_to[1] };
+	s.z_override = { r.override_enabled[2] != 0, r.override_to[2] };
+
+	s.anchor_device_id = r.anchor_device_id;
+	s.should_predict_position = r.should_predict_position != 0;
+	s.position_prediction_strength = r.position_prediction_strength;
+	s.use_jitter_buffer = r.use_jitter_buffer != 0;
+	s.use_onboard_fusion = r.use_onboard_fusion != 0;
+	s.use_yaw_drift_correction = r.use_yaw_drift_correction != 0;
+	s.use_smoothing = r.use_smoothing != 0;
+	s.smoothing_min_cutoff = r.smoothing_min_cutoff;
+	s.smoothing_beta = r.smoothing_beta;
+
+	return s;
+}
+
+static StoredSnapshot to_stored(const TrackerSnapshot& s) {
+	StoredSnapshot r;
+	memset(&r, 0, sizeof(r));
+
+	r.taken_at = s.taken_at;
+	r.client_addr = s.connection.client_addr;
+	r.client_port = s.connection.client_port;
+	r.connection_state = s.connection.state;
+	for (int i = 0; i < 3; i++)
+		r.gyro_bias[i] = s.gyro_bias[i];
+
+	return r;
+}
+
+static TrackerSnapshot from_stored(const StoredSnapshot& r) {
+	TrackerSnapshot s;
+
+	s.taken_at = r.taken_at;
+	s.connection.client_addr = r.client_addr;
+	s.connection.client_port = r.client_port;
+	s.connection.state = r.connection_state;
+	for (int i = 0; i < 3; i++)
+		s.gyro_bias[i] = r.gyro_bias[i];
+
+	return s;
+}
+
+static uint32_t header_crc(const StoreHeader& h) {
+	return crc32(&h, offsetof(StoreHeader, crc));
+}
+
+static uint32_t record_crc(const SettingsStore::Record& r) {
+	return crc32(&r, offsetof(SettingsStore::Record, crc));
+}
+
+static uint32_t snapshot_crc(const StoredSnapshot& r) {
+	// never 0, that marks a record without one
+	return crc32(&r, offsetof(StoredSnapshot, crc)) | 1;
+}
+
+SettingsStore::~SettingsStore() {
+	close();
+}
+
+bool SettingsStore::open(const std::string& path) {
+	close();
+	if (path.empty()) return false;
+
+	HANDLE f = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (f == INVALID_HANDLE_VALUE) {
+		DRIVER_LOG("Could not open settings store %s (%d)", path.c_str(), (int)GetLastError());
+		return false;
+	}
+	file = f;
+
+	// grows the file to the full size if it's new or short
+	HANDLE m = CreateFileMappingA(f, NULL, PAGE_READWRITE, 0, (DWORD)STORE_FILE_SIZE, NULL);
+	if (m == NULL) {
+		DRIVER_LOG("Could not map settings store (%d)", (int)GetLastError());
+		close();
+		return false;
+	}
+	mapping = m;
+
+	view = (unsigned char*)MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, STORE_FILE_SIZE);
+	if (view == nullptr) {
+		DRIVER_LOG("Could not map settings store (%d)", (int)GetLastError());
+		close();
+		return false;
+	}
+
+	StoreHeader* header = (StoreHeader*)view;
+	bool valid = header->magic == SETTINGS_STORE_MAGIC
+		&& header->version == SETTINGS_STORE_VERSION
+		&& header->record_size == sizeof(Record)
+		&& header->record_count == MAX_STORED_TRACKERS
+		&& header->crc == header_crc(*header);
+
+	if (!valid) {
+		if (header->magic != 0)
+			DRIVER_LOG("Settings store is from another version or damaged, starting over");
+
+		memset(view, 0, STORE_FILE_SIZE);
+		header->magic = SETTINGS_STORE_MAGIC;
+		header->version = SETTINGS_STORE_VERSION;
+		header->record_size = sizeof(Record);
+		header->record_count = MAX_STORED_TRACKERS;
+		header->crc = header_crc(*header);
+	}
+
+	return true;
+}
+
+void SettingsStore::close() {
+	if (view) {
+		FlushViewOfFile(view, 0);
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+	if (mapping) {
+		CloseHandle((HANDLE)mapping);
+		mapping = nullptr;
+	}
+	if (file) {
+		CloseHandle((HANDLE)file);
+		file = nullptr;
+	}
+}
+
+SettingsStore::Record* SettingsStore::get_record(int i) const {
+	return (Record*)(view + sizeof(StoreHeader)) + i;
+}
+
+SettingsStore::Record* SettingsStore::find(const std::string& serial) const {
+	for (int i = 0; i < MAX_STORED_TRACKERS; i++) {
+		Record* r = get_record(i);
+		if (r->serial[0] != 0 && strncmp(r->serial, serial.c_str(), STORED_SERIAL_LEN) == 0)
+			return r;
+	}
+	return nullptr;
+}
+
+std::vector<StoredTracker> SettingsStore::load() const {
+	std::vector<StoredTracker> result;
+	if (!view) return result;
+
+	for (int i = 0; i < MAX_STORED_TRACKERS; i++) {
+		Record* r = get_record(i);
+		if (r->serial[0] == 0) continue;
+
+		if (r->crc != record_crc(*r) || r->serial[STORED_SERIAL_LEN - 1] != 0) {
+			// torn write from a crash mid-update, better the defaults than garbage
+			DRIVER_LOG("Dropping damaged settings record %d", i);
+			memset(r, 0, sizeof(Record));
+			continue;
+		}
+
+		StoredTracker stored = { r->serial, r->serial_index, r->port, from_stored(r->settings), false, TrackerSnapshot() };
+
+		if (r->snapshot.crc != 0) {
+			if (r->snapshot.crc == snapshot_crc(r->snapshot)) {
+				stored.has_snapshot = true;
+				stored.snapshot = from_stored(r->snapshot);
+			}
+			else {
+				DRIVER_LOG("Dropping damaged snapshot of %s", r->serial);
+			}
+		}
+
+		result.push_back(stored);
+	}
+
+	std::sort(result.begin(), result.end(), [](const StoredTracker& a, const StoredTracker& b) {
+		return a.serial_index < b.serial_index;
+	});
+
+	return result;
+}
+
+void SettingsStore::save(const std::string& serial, unsigned int serial_index, int port, const RemoteTrackerSettings& settings) {
+	if (!view || serial.empty() || serial.size() >= STORED_SERIAL_LEN) return;
+
+	StoredSettings stored = to_stored(settings);
+
+	Record* r = find(serial);
+	if (r) {
+		if (r->port == port && r->serial_index == serial_index && memcmp(&r->settings, &stored, sizeof(stored)) == 0)
+			return;
+	}
+	else {
+		for (int i = 0; i < MAX_STORED_TRACKERS && !r; i++) {
+			if (get_record(i)->serial[0] == 0) r = get_record(i);
+		}
+		if (!r) {
+			DRIVER_LOG("Settings store is full, %s won't be remembered", serial.c_str());
+			return;
+		}
+
+		memset(r, 0, sizeof(Record));
+		memcpy(r->serial, serial.c_str(), serial.size());
+	}
+
+	r->serial_index = serial_index;
+	r->port = port;
+	r->settings = stored;
+	r->crc = record_crc(*r);
+}
+
+void SettingsStore::save_snapshot(const std::string& serial, const TrackerSnapshot& snapshot) {
+	if (!view) return;
+
+	Record* r = find(serial);
+	if (!r) return;
+
+	r->snapshot = to_stored(snapshot);
+	r->snapshot.crc = snapshot_crc(r->snapshot);
+}
+
+void SettingsStore::remove(const std::string& serial) {
+	if (!view) return;
+
+	Record* r = find(serial);
+	if (r) memset(r, 0, sizeof(Record));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RemoteTrackerSettings.h"
+#include "TrackerSnapshot.h"
+
+#define MAX_STORED_TRACKERS 32
+#define STORED_SERIAL_LEN 32
+
+struct StoredTracker {
+	std::string serial;
+	unsigned int serial_index;
+	int port;
+	RemoteTrackerSettings settings;
+
+	bool has_snapshot;
+	TrackerSnapshot snapshot;
+};
+
+// tracker settings kept between runs, keyed by serial, along with a snapshot of their live state.
+// the file is a fixed array of checksummed records mapped into memory, so a change
+// only rewrites that tracker's record and the OS writes it back, even if the driver crashes
+class SettingsStore {
+private:
+	void* file = nullptr;
+	void* mapping = nullptr;
+	unsigned char* view = nullptr;
+
+public:
+	// on-disk layout, see SettingsStore.cpp
+	struct Record;
+
+private:
+	Record* get_record(int i) const;
+	Record* find(const std::string& serial) const;
+
+public:
+	~SettingsStore();
+
+	// maps the file, starting it over if it's missing or from another version.
+	// false if it can't be used, then everything else does nothing
+	bool open(const std::string& path);
+	void close();
+
+	// trackers that were live when last saved, by serial index
+	std::vector<StoredTracker> load() const;
+
+	// only touches the file if something changed
+	void save(const std::string& serial, unsigned int serial_index, int port, const RemoteTrackerSettings& settings);
+	void remove(const std::string& serial);
+
+	// only for trackers that were saved, checksummed apart from the settings
+	// so a torn snapshot doesn't cost the calibration
+	void save_snapshot(const std::string& serial, const TrackerSnapshot& snapshot);
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// low 16 bits slot index, high 16 bits generation. a slot's first generation is 0,
+// so the first handles handed out are just 0, 1, 2...
+typedef unsigned int slot_handle_t;
+#define INVALID_SLOT_HANDLE 0xFFFFFFFFu
+
+// O(1) insert, erase and lookup by handle, values stay packed for iteration.
+// erasing bumps the slot's generation, so old handles to it stop resolving
+template<typename T>
+class SlotMap {
+public:
+	static const uint32_t MAX_SLOTS = 0xFFFF;
+
+private:
+	struct Slot {
+		uint16_t generation = 0;
+		bool live = false;
+		uint32_t dense_index = 0;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> free_slots;
+
+	// packed, in no particular order
+	std::vector<T> values;
+	std::vector<uint32_t> value_slots;
+
+	static uint32_t index_of(slot_handle_t handle) { return handle & 0xFFFF; }
+	static uint16_t generation_of(slot_handle_t handle) { return (uint16_t)(handle >> 16); }
+	static slot_handle_t make_handle(uint32_t index, uint16_t generation) { return index | ((slot_handle_t)generation << 16); }
+
+	Slot* find(slot_handle_t handle) {
+		uint32_t index = index_of(handle);
+		if (index >= slots.size()) return nullptr;
+
+		Slot& slot = slots[index];
+		if (!slot.live || (slot.generation != generation_of(handle))) return nullptr;
+		return &slot;
+	}
+
+public:
+	slot_handle_t insert(const T& value) {
+		uint32_t index;
+		if (!free_slots.empty()) {
+			index = free_slots.back();
+			free_slots.pop_back();
+		}
+		else {
+			if (slots.size() >= MAX_SLOTS) return INVALID_SLOT_HANDLE;
+			index = (uint32_t)slots.size();
+			slots.emplace_back();
+		}
+
+		Slot& slot = slots[index];
+		slot.live = true;
+		slot.dense_index = (uint32_t)values.size();
+
+		values.push_back(value);
+		value_slots.push_back(index);
+
+		return make_handle(index, slot.generation);
+	}
+
+	bool erase(slot_handle_t handle) {
+		Slot* slot = find(handle);
+		if (!slot) return false;
+
+		// the last value moves into the hole
+		uint32_t hole = slot->dense_index;
+		uint32_t last = (uint32_t)values.size() - 1;
+		if (hole != last) {
+			values[hole] = values[last];
+			value_slots[hole] = value_slots[last];
+			slots[value_slots[hole]].dense_index = hole;
+		}
+		values.pop_back();
+		value_slots.pop_back();
+
+		slot->live = false;
+		slot->generation++;
+		free_slots.push_back(index_of(handle));
+		return true;
+	}
+
+	// nullptr for handles that were erased or never handed out
+	T* get(slot_handle_t handle) {
+		Slot* slot = find(handle);
+		return slot ? &values[slot->dense_index] : nullptr;
+	}
+
+	size_t size() const { return values.size(); }
+
+	// packed access, indices shift when something is erased
+	T& value_at(size_t dense_index) { return values[dense_index]; }
+	slot_handle_t handle_at(size_t dense_index) const {
+		uint32_t index = value_slots[dense_index];
+		return make_handle(index, slots[index].generation);
+	}
+
+	typename std::vector<T>::iterator begin() { return values.begin(); }
+	typename std::vector<T>::iterator end() { return values.end(); }
+};
@@ -0,0 +1,113 @@
+#include "TimerWheel.h"
+
+TimerWheel::Timer::~Timer() {
+	if (is_scheduled()) TimerWheel::unlink(*this);
+}
+
+TimerWheel::TimerWheel() {
+	current_time = get_time_us();
+	current_tick = current_time / TICK_US;
+
+	for (int l = 0; l < LEVELS; l++) {
+		for (int s = 0; s < SLOTS; s++) {
+			slots[l][s].prev = &slots[l][s];
+			slots[l][s].next = &slots[l][s];
+		}
+	}
+}
+
+TimerWheel::~TimerWheel() {
+	// leave the owners' timers in a sane state
+	for (int l = 0; l < LEVELS; l++) {
+		for (int s = 0; s < SLOTS; s++) {
+			Timer& head = slots[l][s];
+			while (head.next != &head) unlink(*head.next);
+		}
+	}
+}
+
+void TimerWheel::unlink(Timer& timer) {
+	timer.prev->next = timer.next;
+	timer.next->prev = timer.prev;
+	timer.prev = nullptr;
+	timer.next = nullptr;
+}
+
+void TimerWheel::link(Timer& timer) {
+	unsigned long long max_ticks = (1ULL << (LEVEL_BITS * LEVELS)) - 1;
+
+	if (timer.expires_tick <= current_tick)
+		timer.expires_tick = current_tick + 1;
+	if (timer.expires_tick - current_tick > max_ticks)
+		timer.expires_tick = current_tick + max_ticks;
+
+	unsigned long long delta = timer.expires_tick - current_tick;
+
+	int level = 0;
+	while ((level < LEVELS - 1) && (delta >= (1ULL << (LEVEL_BITS * (level + 1)))))
+		level++;
+
+	int slot = (int)((timer.expires_tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+	Timer& head = slots[level][slot];
+
+	timer.prev = head.prev;
+	timer.next = &head;
+	head.prev->next = &timer;
+	head.prev = &timer;
+}
+
+void TimerWheel::schedule(Timer& timer, timestamp_us_t delay_us) {
+	if (timer.is_scheduled()) unlink(timer);
+
+	timer.expires_tick = (current_time + delay_us + TICK_US - 1) / TICK_US;
+	link(timer);
+}
+
+void TimerWheel::cancel(Timer& timer) {
+	if (timer.is_scheduled()) unlink(timer);
+}
+
+// moves the timers of the slot that just came due on this level down a level
+void TimerWheel::cascade(int level) {
+	int slot = (int)((current_tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+	Timer& head = slots[level][slot];
+
+	while (head.next != &head) {
+		Timer& timer = *head.next;
+		unlink(timer);
+		link(timer);
+	}
+}
+
+void TimerWheel::run_slot(Timer& head) {
+	// callbacks may reschedule themselves, they'd land in a later slot
+	while (head.next != &head) {
+		Timer& timer = *head.next;
+		unlink(timer);
+		if (timer.callback) timer.callback();
+	}
+}
+
+void TimerWheel::advance(timestamp_us_t now) {
+	current_time = now;
+
+	unsigned long long target_tick = now / TICK_US;
+	while (current_tick < target_tick) {
+		current_tick++;
+
+		if ((current_tick & (SLOTS - 1)) == 0) {
+			// wrapped around, pull down the next slot of every level that wrapped too
+			int level = 1;
+			while ((level < LEVELS - 1) && (((current_tick >> (LEVEL_BITS * level)) & (SLOTS - 1)) == 0))
+				level++;
+			for (; level >= 1; level--)
+				cascade(level);
+		}
+
+		run_slot(slots[0][current_tick & (SLOTS - 1)]);
+	}
+}
+
+timestamp_us_t TimerWheel::now() const {
+	return current_time;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+
+#include "timeutil.h"
+
+// hierarchical timer wheel shared by all connections.
+// schedule and cancel are O(1), advance costs one slot per elapsed tick plus the timers that expire
+class TimerWheel {
+public:
+	class Timer {
+	private:
+		friend class TimerWheel;
+
+		Timer* prev = nullptr;
+		Timer* next = nullptr;
+		unsigned long long expires_tick = 0;
+
+	public:
+		std::function<void()> callback;
+
+		Timer() {}
+		Timer(std::function<void()> cb) : callback(cb) {}
+		~Timer();
+		Timer(const Timer&) = delete;
+		Timer& operator=(const Timer&) = delete;
+
+		bool is_scheduled() const { return next != nullptr; }
+	};
+
+	static const timestamp_us_t TICK_US = 4000;
+
+private:
+	static const int LEVEL_BITS = 6;
+	static const int SLOTS = 1 << LEVEL_BITS;
+	static const int LEVELS = 3;
+
+	// circular list heads
+	Timer slots[LEVELS][SLOTS];
+
+	unsigned long long current_tick = 0;
+	timestamp_us_t current_time = 0;
+
+	void link(Timer& timer);
+	static void unlink(Timer& timer);
+	void cascade(int level);
+	void run_slot(Timer& head);
+
+public:
+	TimerWheel();
+	~TimerWheel();
+
+	// (re)schedules timer to fire delay_us from now
+	void schedule(Timer& timer, timestamp_us_t delay_us);
+	void cancel(Timer& timer);
+
+	// fires every timer due by now
+	void advance(timestamp_us_t now);
+
+	timestamp_us_t now() const;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "DeviceQuatServer.h"
+
+// live state of a tracker worth carrying over a driver restart. things that settle
+// within a few packets (pose, prediction, smoothing, fusion) would only be stale
+struct TrackerSnapshot {
+	unsigned long long taken_at = 0; // get_wall_time_us()
+	ConnectionSnapshot connection;
+	double gyro_bias[3] = { 0.0, 0.0, 0.0 }; // takes a few seconds of lying still to learn
+};
@@ -1,40 +1,157 @@
 #include "UDPDeviceQuatServer.h"
 #include "driverlog.h"
 
-#include <ctime>
-
-#include "ByteBuffer.h"
-using namespace bb;
+#include <cstring>
 
 void UDPDeviceQuatServer::send_heartbeat() {
-	hb_accum += 1;
+	// phones that support clock sync echo the driver time back in a MSG_CLOCK_SYNC,
+	// older ones only read the first two ints
+	char* msg = outbound.reserve(HeartbeatPacket::size);
+	if (!msg) return;
+
+	PacketWriter<HeartbeatPacket, OUT_ORDER>(msg)
+		.set<0>(MSG_OUT_HEARTBEAT)
+		.set<1>(0)
+		.set<2>(get_time_us());
+}
+
+void UDPDeviceQuatServer::send_hello() {
+	char* msg = outbound.reserve(buff_hello_len);
+	if (!msg) return;
+
+	memcpy(msg, buff_hello, buff_hello_len);
+}
+
+void UDPDeviceQuatServer::on_contact(message_header_type_t msg_type) {
+	last_contact_time = packet_time;
+
+	ConnectionState prev_state = state;
+
+	switch (msg_type) {
+	case MSG_HANDSHAKE:
+		// new or restarted app
+		state = CONN_HANDSHAKING;
+		handshake_retries_left = config.handshake_retries;
+		timers.schedule(handshake_timer, config.handshake_retry_ms * 1000ULL);
+		break;
+	case MSG_HEARTBEAT:
+		if (state == CONN_DEAD || state == CONN_STALLED)
+			state = CONN_STREAMING;
+		break;
+	default:
+		state = CONN_STREAMING;
+		break;
+	}
+
+	if (prev_state == CONN_DEAD)
+		timers.schedule(heartbeat_timer, config.heartbeat_interval_ms * 1000ULL);
+
+	// the liveness timer re-arms itself lazily, only a state change needs it moved
+	if ((state != prev_state) || !liveness_timer.is_scheduled())
+		timers.schedule(liveness_timer, config.stall_threshold_ms * 1000ULL);
+}
 
-	if (hb_accum > 200) {
-		hb_accum = 0;
+void UDPDeviceQuatServer::on_heartbeat_timer() {
+	if (state == CONN_DEAD) return;
 
-		if (!isConnectionAlive())
+	send_heartbeat();
+	timers.schedule(heartbeat_timer, config.heartbeat_interval_ms * 1000ULL);
+}
+
+void UDPDeviceQuatServer::on_liveness_timer() {
+	timestamp_us_t now = timers.now();
+	timestamp_us_t silence = (now > last_contact_time) ? (now - last_contact_time) : 0;
+
+	timestamp_us_t stall_us = config.stall_threshold_ms * 1000ULL;
+	timestamp_us_t dead_us = config.dead_threshold_ms * 1000ULL;
+
+	if (state == CONN_STREAMING) {
+		if (silence < stall_us) {
+			timers.schedule(liveness_timer, stall_us - silence);
 			return;
+		}
+		state = CONN_STALLED;
+	}
 
-		ByteBuffer buff(sizeof(int) * 2);
-		buff.putInt(1);
-		buff.putInt(0);
+	if (state == CONN_DEAD) return;
 
-		send_bytebuffer(buff);
+	if (silence < dead_us) {
+		timers.schedule(liveness_timer, dead_us - silence);
+		return;
 	}
+
+	state = CONN_DEAD;
+}
+
+void UDPDeviceQuatServer::on_handshake_timer() {
+	if ((state != CONN_HANDSHAKING) || (handshake_retries_left <= 0)) return;
+	handshake_retries_left--;
+
+	send_hello();
+	timers.schedule(handshake_timer, config.handshake_retry_ms * 1000ULL);
+}
+
+
+
+bool UDPDeviceQuatServer::is_socket_usable() {
+	if (socket_failed) return false;
+	return get_time_us() >= socket_backoff_until;
 }
 
+void UDPDeviceQuatServer::on_socket_error(int err, const char* op) {
+	stats.socket_errors++;
+
+	if (!is_transient_socket_error(err)) {
+		DRIVER_LOG("%s on port %d failed with %d, giving up on the socket", op, portno, err);
+		socket_failed = true;
+		state = CONN_DEAD;
+		return;
+	}
 
+	consecutive_socket_errors++;
+	if (consecutive_socket_errors < SOCKET_ERROR_BACKOFF_THRESHOLD) return;
 
-void UDPDeviceQuatServer::send_bytebuffer(ByteBuffer& b){
-	uint8_t* buff_c = (uint8_t*)malloc(b.size());
-	b.getBytes(buff_c, b.size());
+	// doubles with every error past the threshold
+	int shift = consecutive_socket_errors - SOCKET_ERROR_BACKOFF_THRESHOLD;
+	timestamp_us_t backoff_ms = (shift < 7) ? (SOCKET_BACKOFF_MIN_MS << shift) : SOCKET_BACKOFF_MAX_MS;
+	if (backoff_ms > SOCKET_BACKOFF_MAX_MS) backoff_ms = SOCKET_BACKOFF_MAX_MS;
 
-	Socket.SendTo(client, (char*)buff_c, b.size());
+	socket_backoff_until = get_time_us() + backoff_ms * 1000ULL;
 
-	free((void*)buff_c);
+	// only once per run of errors, not every backoff period
+	if (consecutive_socket_errors == SOCKET_ERROR_BACKOFF_THRESHOLD)
+		DRIVER_LOG("%s on port %d keeps failing with %d, backing off", op, portno, err);
 }
 
-UDPDeviceQuatServer::UDPDeviceQuatServer(int portno_v) : NetworkedDeviceQuatServer() {
+void UDPDeviceQuatServer::flush() {
+	// nobody to send to yet
+	if ((client.sin_port == 0) || !is_socket_usable()) {
+		outbound.clear();
+		return;
+	}
+
+	// winsock has no sendmmsg, so this is still a sendto per message,
+	// but messages are built in place and leave together once per frame
+	for (int i = 0; i < outbound.size(); i++) {
+		int err = Socket.SendTo(client, outbound.get(i), outbound.get_length(i));
+		stats.send_calls++;
+
+		if (err != 0) {
+			// the rest gets regenerated by the timers and haptics anyway
+			on_socket_error(err, "sendto");
+			break;
+		}
+
+		stats.messages_sent++;
+	}
+
+	outbound.clear();
+}
+
+UDPDeviceQuatServer::UDPDeviceQuatServer(int portno_v, TimerWheel& timer_wheel, const DriverConfig& config_v) : NetworkedDeviceQuatServer(), timers(timer_wheel), config(config_v),
+	heartbeat_timer([this] { on_heartbeat_timer(); }),
+	liveness_timer([this] { on_liveness_timer(); }),
+	handshake_timer([this] { on_handshake_timer(); }) {
 	buffer = (char*)malloc(sizeof(char) * MAX_MSG_SIZE);
 
 	portno = portno_v;
@@ -44,67 +161,124 @@ UDPDeviceQuatServer::UDPDeviceQuatServer(int portno_v) : NetworkedDeviceQuatServ
 
 
 void UDPDeviceQuatServer::startListening() {
+	// a restored tracker is bound before SteamVR activates it
+	if (listening) return;
+
 	Socket.Bind(portno);
+	listening = true;
+
+	if (!Socket.HasRxTimestamps())
+		DRIVER_LOG("Port %d: no kernel receive timestamps before Windows 10 2004, latency leaves out socket queueing", portno);
 }
 
 bool UDPDeviceQuatServer::more_data_exists__read() {
-	// read header
-	curr_time = static_cast<unsigned long long>(std::time(nullptr));
-
-	bool is_recv = Socket.RecvFrom(buffer, MAX_MSG_SIZE, reinterpret_cast<SOCKADDR*>(&client));
-	if (!is_recv) return false;
+	sockaddr_in from;
+	int received = 0;
+	int err = Socket.RecvFrom(buffer, MAX_MSG_SIZE, reinterpret_cast<SOCKADDR*>(&from), received, packet_time);
+	if (err == WSAEWOULDBLOCK) return false;
+	if (err != 0) {
+		on_socket_error(err, "recvfrom");
+		return false;
+	}
 
-	message_header_type_t msg_type = convert_chars<message_header_type_t>((unsigned char*)buffer);
+	consecutive_socket_errors = 0;
 
+	// too short to even have a header, drop it
+	PacketReader<PacketHeader, IN_ORDER> header(buffer, received);
+	if (!header.valid()) return true;
 
-	last_contact_time = curr_time;
-	connectionIsDead = false;
+	// read header
+	message_header_type_t msg_type = header.get<0>();
+	const unsigned char* packet = (const unsigned char*)buffer;
 
+	bool accepted;
 	switch (msg_type) {
 	case MSG_HEARTBEAT:
-		return true;
+	case MSG_HANDSHAKE:
+		// nothing past the header is read
+		accepted = true;
+		break;
 	case MSG_ROTATION:
-		handle_rotation_packet((unsigned char*)buffer);
-		return true;
+		accepted = handle_rotation_packet(packet, received);
+		break;
 	case MSG_GYRO:
-		handle_gyro_packet((unsigned char*)buffer);
-		return true;
+		accepted = handle_gyro_packet(packet, received);
+		break;
 	case MSG_ACCELEROMETER:
-		handle_accel_packet((unsigned char*)buffer);
-		return true;
-	case MSG_HANDSHAKE:
-		Socket.SendTo(client, buff_hello, buff_hello_len);
-		return true;
+		accepted = handle_accel_packet(packet, received);
+		break;
+	case MSG_ROTATION_TIMESTAMPED:
+		accepted = handle_timestamped_rotation_packet(packet, received);
+		break;
+	case MSG_CLOCK_SYNC:
+		accepted = handle_clock_sync_packet(packet, received);
+		break;
 	default:
-		return true;
+		accepted = false;
+		break;
 	}
+
+	// unknown or cut short, it doesn't count as hearing from the client
+	// and whoever sent it isn't who replies go to
+	if (!accepted) return true;
+
+	client = from;
+	on_contact(msg_type);
+
+	if (msg_type == MSG_HANDSHAKE)
+		send_hello();
+
 	return true;
 }
 
 void UDPDeviceQuatServer::tick() {
-	send_heartbeat();
+	if (!is_socket_usable()) return;
+
 	while (more_data_exists__read()) {}
 }
 
 bool UDPDeviceQuatServer::isConnectionAlive() {
-	// cache
-	if (connectionIsDead)
-		return false;
+	return (state == CONN_STREAMING) || (state == CONN_HANDSHAKING);
+}
+
+ConnectionState UDPDeviceQuatServer::getConnectionState() {
+	return state;
+}
+
+ConnectionSnapshot UDPDeviceQuatServer::getConnectionSnapshot() {
+	ConnectionSnapshot snapshot;
+	snapshot.client_addr = client.sin_addr.s_addr;
+	snapshot.client_port = client.sin_port;
+	snapshot.state = (uint16_t)state;
+	return snapshot;
+}
+
+void UDPDeviceQuatServer::resumeConnection(const ConnectionSnapshot& snapshot) {
+	if ((snapshot.client_port == 0) || (snapshot.state == CONN_DEAD)) return;
+
+	client = { 0 };
+	client.sin_family = AF_INET;
+	client.sin_addr.s_addr = snapshot.client_addr;
+	client.sin_port = snapshot.client_port;
 
-	if ((curr_time - last_contact_time) > 2)
-		connectionIsDead = true;
+	// stalled until it's heard from, so it goes dead on the usual timeout if it's gone.
+	// the first heartbeat goes out on the next frame, before the phone gives up on us
+	state = CONN_STALLED;
+	last_contact_time = get_time_us();
 
-	return !connectionIsDead;
+	timers.schedule(heartbeat_timer, 0);
+	timers.schedule(liveness_timer, config.dead_threshold_ms * 1000ULL);
 }
 
 void UDPDeviceQuatServer::buzz(float duration_s, float frequency, float amplitude){
-	ByteBuffer buff(sizeof(int) + sizeof(float)*3);
-	buff.putInt(2);
-	buff.putFloat(duration_s);
-	buff.putFloat(frequency);
-	buff.putFloat(amplitude);
+	char* msg = outbound.reserve(BuzzPacket::size);
+	if (!msg) return;
 
-	send_bytebuffer(buff);
+	PacketWriter<BuzzPacket, OUT_ORDER>(msg)
+		.set<0>(MSG_OUT_BUZZ)
+		.set<1>(duration_s)
+		.set<2>(frequency)
+		.set<3>(amplitude);
 }
 
 int UDPDeviceQuatServer::get_port(){
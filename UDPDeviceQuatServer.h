@@ -2,9 +2,9 @@
 
 #include "NetworkedDeviceQuatServer.h"
 #include "Network.h"
-
-#include "ByteBuffer.h"
-using namespace bb;
+#include "TimerWheel.h"
+#include "OutboundQueue.h"
+#include "DriverConfig.h"
 
 class UDPDeviceQuatServer : public NetworkedDeviceQuatServer {
 private:
@@ -15,27 +15,56 @@ private:
 	sockaddr_in client;
 
 	void send_heartbeat();
+	void send_hello();
 
 	char* buffer;
 
 	bool more_data_exists__read();
 
-	unsigned long long last_contact_time = 0;
-	unsigned long long curr_time = 0;
+	timestamp_us_t last_contact_time = 0;
+
+	ConnectionState state = CONN_DEAD;
+
+	void on_contact(message_header_type_t msg_type);
+
+	// heartbeats, timeouts and handshake retries run off the driver's shared wheel,
+	// with the intervals from the driver's config as it is at the time
+	TimerWheel& timers;
+	const DriverConfig& config;
+	TimerWheel::Timer heartbeat_timer;
+	TimerWheel::Timer liveness_timer;
+	TimerWheel::Timer handshake_timer;
+
+	int handshake_retries_left = 0;
+
+	void on_heartbeat_timer();
+	void on_liveness_timer();
+	void on_handshake_timer();
+
+	OutboundQueue outbound;
 
-	bool connectionIsDead = false;
+	// a client that keeps erroring out shouldn't cost frame time, so the socket
+	// is left alone for a while after repeated errors, and for good after a fatal one
+	int consecutive_socket_errors = 0;
+	timestamp_us_t socket_backoff_until = 0;
+	bool socket_failed = false;
 
-	int hb_accum;
+	bool listening = false;
 
-	void send_bytebuffer(ByteBuffer& b);
+	bool is_socket_usable();
+	void on_socket_error(int err, const char* op);
 
 public:
-	UDPDeviceQuatServer(int portno_v);
+	UDPDeviceQuatServer(int portno_v, TimerWheel& timer_wheel, const DriverConfig& config_v);
 
 	void startListening();
 	void tick();
+	void flush();
 
 	bool isConnectionAlive();
+	ConnectionState getConnectionState();
+	ConnectionSnapshot getConnectionSnapshot();
+	void resumeConnection(const ConnectionSnapshot& snapshot);
 
 	void buzz(float duration_s, float frequency, float amplitude);
 
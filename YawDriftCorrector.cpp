@@ -0,0 +1,70 @@
+#include "YawDriftCorrector.h"
+
+#include <cmath>
+#include "shared.h"
+
+// how far back the mean reaches, seconds of walking
+#define AVERAGE_TAU 20.0
+
+// walking needed before trusting the mean at all
+#define MIN_WALKING_TIME 10.0
+
+// length of the mean vector, below this the headings were all over the place
+#define MIN_COHERENCE 0.8
+
+// time constant and top speed of the correction itself
+#define CORRECTION_TAU 30.0
+#define MAX_CORRECTION_RATE (Math_PI / 180.0) // rad/s
+
+#define MAX_DT 0.1
+
+double YawDriftCorrector::update(double error, bool walking, timestamp_us_t now) {
+	if (last_time == 0) {
+		last_time = now;
+		return 0.0;
+	}
+
+	double dt = (now > last_time) ? (now - last_time) / 1000000.0 : 0.0;
+	last_time = now;
+	if (dt > MAX_DT) dt = MAX_DT;
+
+	if (walking) {
+		double alpha = 1.0 - std::exp(-dt / AVERAGE_TAU);
+		mean_cos += (std::cos(error) - mean_cos) * alpha;
+		mean_sin += (std::sin(error) - mean_sin) * alpha;
+
+		// past a few time constants the mean is as filled in as it gets
+		if (walking_time < AVERAGE_TAU * 10.0) walking_time += dt;
+	}
+
+	// standing still says nothing about the heading, and the mean would keep pushing
+	if (!walking || walking_time < MIN_WALKING_TIME) return 0.0;
+
+	// the mean starts out biased towards zero, normalized by how much of it is filled in
+	double filled = 1.0 - std::exp(-walking_time / AVERAGE_TAU);
+	double coherence = std::sqrt(mean_cos * mean_cos + mean_sin * mean_sin) / filled;
+	if (coherence < MIN_COHERENCE) return 0.0;
+
+	double mean_error = std::atan2(mean_sin, mean_cos);
+	double step = mean_error * (1.0 - std::exp(-dt / CORRECTION_TAU));
+
+	double max_step = MAX_CORRECTION_RATE * dt;
+	if (step > max_step) step = max_step;
+	if (step < -max_step) step = -max_step;
+
+	// the errors already in the mean were measured before this step, turn them by
+	// it too so the correction isn't applied again while they age out
+	double c = std::cos(step), s = std::sin(step);
+	double rotated_cos = mean_cos * c + mean_sin * s;
+	mean_sin = mean_sin * c - mean_cos * s;
+	mean_cos = rotated_cos;
+
+	return step;
+}
+
+void YawDriftCorrector::reset() {
+	mean_cos = 0.0;
+	mean_sin = 0.0;
+	walking_time = 0.0;
+	last_time = 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "timeutil.h"
+
+// keeps the calibrated yaw offset following the phone's yaw drift. while walking the hips
+// and the head face the same way on average, so the yaw of the fully calibrated tracker
+// relative to the anchor is averaged over time and the offset eased until it's zero
+class YawDriftCorrector {
+private:
+	// circular running mean of the tracker's yaw relative to the anchor
+	double mean_cos = 0.0;
+	double mean_sin = 0.0;
+
+	// seconds of walking the mean is based on
+	double walking_time = 0.0;
+
+	timestamp_us_t last_time = 0;
+
+public:
+	// error is the calibrated tracker's yaw minus the anchor's, returns how much to add
+	// to the yaw offset this frame (a larger offset turns the tracker the other way)
+	double update(double error, bool walking, timestamp_us_t now);
+
+	void reset();
+};
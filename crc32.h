@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// plain CRC-32 (IEEE, reflected), same as zlib's. only for catching torn or stale records
+// in the files the driver keeps between runs, not for anything adversarial
+inline uint32_t crc32(const void* data, size_t len, uint32_t crc = 0) {
+	struct Table {
+		uint32_t v[256];
+		Table() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++)
+					c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+				v[i] = c;
+			}
+		}
+	};
+	static const Table table;
+
+	const unsigned char* p = (const unsigned char*)data;
+	crc = ~crc;
+	for (size_t i = 0; i < len; i++)
+		crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
@@ -0,0 +1,14 @@
+#include "datadir.h"
+
+#include <windows.h>
+
+std::string get_data_dir() {
+	char base[MAX_PATH];
+	DWORD len = GetEnvironmentVariableA("LOCALAPPDATA", base, MAX_PATH);
+	if (len == 0 || len >= MAX_PATH) return "";
+
+	std::string dir = std::string(base) + "\\owoTrack";
+	CreateDirectoryA(dir.c_str(), NULL); // fails harmlessly if it exists
+
+	return dir;
+}
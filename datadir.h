@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// %LOCALAPPDATA%\owoTrack, where the driver keeps its files between runs.
+// created if it doesn't exist, empty if there's nowhere to put it
+std::string get_data_dir();
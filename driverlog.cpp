@@ -4,33 +4,138 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "LogQueue.h"
+#include "LogRateLimiter.h"
+#include "timeutil.h"
 
 static vr::IVRDriverLog * s_pLogFile = NULL;
 
-#if !defined( WIN32)
-#define vsnprintf_s vsnprintf
-#endif
+// records are queued on the caller's thread, decoded and handed to IVRDriverLog
+// on this one, so logging from the frame loop never waits on the log file
+static LogQueue s_LogQueue;
+static LogRateLimiter s_RateLimiter;
+
+static std::thread s_LogThread;
+static std::atomic<bool> s_bLogThreadRunning( false );
+
+// how often the log thread wakes up, and how often it reports suppressed lines
+#define LOG_THREAD_SLEEP_MS 5
+#define LOG_SUMMARY_INTERVAL_US 1000000
+
+static void DrainLogQueue()
+{
+	char buf[1024];
+
+	const char *pRecord;
+	while( ( pRecord = s_LogQueue.peek() ) != nullptr )
+	{
+		if( s_pLogFile )
+		{
+			decode_log_record( pRecord, LogQueue::MAX_ENTRY_SIZE, buf, sizeof(buf) );
+			s_pLogFile->Log( buf );
+		}
+		s_LogQueue.pop();
+	}
+}
+
+static void LogSummaries()
+{
+	char buf[LogQueue::MAX_ENTRY_SIZE];
+
+	int idx = 0;
+	const char *pFormat;
+	unsigned int count;
+	while( s_RateLimiter.take_suppressed( idx, pFormat, count ) )
+	{
+		snprintf( buf, sizeof(buf), "(%u similar messages suppressed: %s)", count, pFormat );
+		s_pLogFile->Log( buf );
+	}
+
+	unsigned int dropped = s_LogQueue.take_dropped();
+	if( dropped > 0 )
+	{
+		snprintf( buf, sizeof(buf), "(%u messages dropped, log queue full)", dropped );
+		s_pLogFile->Log( buf );
+	}
+}
+
+static void LogThreadMain()
+{
+	timestamp_us_t last_summary = get_time_us();
+
+	while( s_bLogThreadRunning.load( std::memory_order_acquire ) )
+	{
+		DrainLogQueue();
+
+		timestamp_us_t now = get_time_us();
+		if( now - last_summary >= LOG_SUMMARY_INTERVAL_US )
+		{
+			LogSummaries();
+			last_summary = now;
+		}
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( LOG_THREAD_SLEEP_MS ) );
+	}
+
+	// whatever was logged during shutdown
+	DrainLogQueue();
+	LogSummaries();
+}
 
 bool InitDriverLog( vr::IVRDriverLog *pDriverLog )
 {
 	if( s_pLogFile )
 		return false;
 	s_pLogFile = pDriverLog;
-	return s_pLogFile != NULL;
+	if( s_pLogFile == NULL )
+		return false;
+
+	s_bLogThreadRunning.store( true, std::memory_order_release );
+	s_LogThread = std::thread( LogThreadMain );
+	return true;
 }
 
 void CleanupDriverLog()
 {
+	if( s_LogThread.joinable() )
+	{
+		s_bLogThreadRunning.store( false, std::memory_order_release );
+		s_LogThread.join();
+	}
 	s_pLogFile = NULL;
 }
 
-static void DriverLogVarArgs( const char *pMsgFormat, va_list args )
+char *DriverLogReserve( log_format_id_t id, size_t &ticket )
 {
-	char buf[1024];
-	vsnprintf_s( buf, sizeof(buf), pMsgFormat, args );
+	// the format pointer identifies the call site, overflowed ids just aren't limited
+	const char *pFormat = get_log_format( id );
+	if( pFormat && !s_RateLimiter.allow( pFormat, get_time_us() ) )
+		return nullptr;
 
-	if( s_pLogFile )
-		s_pLogFile->Log( buf );
+	return s_LogQueue.reserve( ticket );
+}
+
+void DriverLogCommit( size_t ticket )
+{
+	s_LogQueue.commit( ticket );
+}
+
+// formats right away, for format strings that aren't literals. those can't be rate limited,
+// the limiter keeps the format pointer around and the string may be gone by then
+static void DriverLogVarArgs( const char *pMsgFormat, va_list args )
+{
+	size_t ticket;
+	char *buf = s_LogQueue.reserve( ticket );
+	if( !buf )
+		return;
+
+	LogRecordWriter writer( buf, LogQueue::MAX_ENTRY_SIZE, LOG_FORMAT_TEXT );
+	vsnprintf( buf + LOG_RECORD_HEADER_SIZE, LogQueue::MAX_ENTRY_SIZE - LOG_RECORD_HEADER_SIZE, pMsgFormat, args );
+	s_LogQueue.commit( ticket );
 }
 
 
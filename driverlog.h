@@ -8,6 +8,9 @@
 #include <string>
 #include <openvr_driver.h>
 
+#include "LogFormat.h"
+#include "LogQueue.h"
+
 extern void DriverLog( const char *pchFormat, ... );
 
 
@@ -17,6 +20,35 @@ extern void DriverLog( const char *pchFormat, ... );
 extern void DebugDriverLog( const char *pchFormat, ... );
 
 
+// --------------------------------------------------------------------------
+// Purpose: Log without formatting on the caller's thread. The format has to be
+//			a string literal, the arguments are copied and formatted by the log thread
+// --------------------------------------------------------------------------
+#define DRIVER_LOG( format, ... ) \
+	do { \
+		static const log_format_id_t _log_format_id = register_log_format( format ); \
+		DriverLogRecord( _log_format_id, ##__VA_ARGS__ ); \
+	} while( 0 )
+
+// slot for a record with the given format, nullptr if it's rate limited or the queue is full
+extern char *DriverLogReserve( log_format_id_t id, size_t &ticket );
+extern void DriverLogCommit( size_t ticket );
+
+template<typename... Args>
+void DriverLogRecord( log_format_id_t id, const Args&... args )
+{
+	size_t ticket;
+	char *buf = DriverLogReserve( id, ticket );
+	if( !buf )
+		return;
+
+	LogRecordWriter writer( buf, LogQueue::MAX_ENTRY_SIZE, id );
+	writer.put_all( args... );
+
+	DriverLogCommit( ticket );
+}
+
+
 extern bool InitDriverLog( vr::IVRDriverLog *pDriverLog );
 extern void CleanupDriverLog();
 
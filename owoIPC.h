@@ -36,7 +36,33 @@ enum owoTrackerSettingType {
 
 	CALIBRATING_DOWN,		// bool_v
 	HIP_MOVE,				// bool_v
-	HIP_MOVE_VECTOR			// vector
+	HIP_MOVE_VECTOR,		// vector
+
+	LATENCY_STATS,			// vector (p50, p99, max) in ms, read-only
+	SAMPLES_OVERWRITTEN,	// index, read-only
+
+	NET_PACKET_COUNTERS,	// vector (lost, reordered, duplicate), read-only
+	NET_STREAM_RESETS,		// index, read-only
+	NET_JITTER,				// double_v in ms, read-only
+	NET_PACKET_RATE,		// double_v in packets/s, read-only
+
+	JITTER_BUFFER,			// bool_v
+	JITTER_BUFFER_DELAY,	// double_v in ms, read-only
+
+	CLOCK_SYNC,				// vector (offset ms, drift ppm, rtt ms), read-only
+	CONN_STATE,				// index (ConnectionState: dead, handshaking, streaming, stalled), read-only
+	NET_SEND_STATS,			// vector (messages sent, send syscalls, messages per syscall), read-only
+	HAPTIC_STATS,			// vector (requests from the game, buzz commands sent, unused), read-only
+	SOCKET_ERRORS,			// index, failed socket calls, read-only
+
+	SMOOTHING,				// bool_v, One Euro filter on the rotation
+	SMOOTHING_MIN_CUTOFF,	// double_v in Hz, cutoff at rest, lower is smoother
+	SMOOTHING_BETA,			// double_v, how fast the cutoff rises with angular speed
+
+	ONBOARD_FUSION,			// bool_v, fuse raw gyro/accel in the driver, phone rotation as slow reference
+	GYRO_BIAS,				// vector in rad/s, estimated while the phone lies still, read-only
+	YAW_DRIFT_CORRECTION,	// bool_v, follow yaw drift against the anchor while walking
+	CALIBRATION_RESIDUAL	// vector (yaw spread deg, down spread deg, samples) of the last calibration, read-only
 };
 
 struct owoEventTrackerSetting {
@@ -92,10 +118,19 @@ template<typename T>
 inline T& get_ref_from_setting_event(owoEventTrackerSetting& ev) {
 	switch (ev.type) {
 	case ANCHOR_DEVICE_ID:
+	case SAMPLES_OVERWRITTEN:
+	case NET_STREAM_RESETS:
+	case CONN_STATE:
+	case SOCKET_ERRORS:
 		return (T&)ev.index;
 
 	case YAW_VALUE:
 	case PREDICT_POSITION_STRENGTH:
+	case NET_JITTER:
+	case NET_PACKET_RATE:
+	case JITTER_BUFFER_DELAY:
+	case SMOOTHING_MIN_CUTOFF:
+	case SMOOTHING_BETA:
 		return (T&)ev.double_v;
 
 	case PREDICT_POSITION:
@@ -103,6 +138,10 @@ inline T& get_ref_from_setting_event(owoEventTrackerSetting& ev) {
 	case IS_CALIBRATING:
 	case IS_CONN_ALIVE:
 	case HIP_MOVE:
+	case JITTER_BUFFER:
+	case SMOOTHING:
+	case ONBOARD_FUSION:
+	case YAW_DRIFT_CORRECTION:
 		return (T&)ev.bool_v;
 
 	case OFFSET_GLOBAL:
@@ -111,6 +150,13 @@ inline T& get_ref_from_setting_event(owoEventTrackerSetting& ev) {
 	case OFFSET_ROT_GLOBAL:
 	case OFFSET_ROT_LOCAL:
 	case HIP_MOVE_VECTOR:
+	case LATENCY_STATS:
+	case NET_PACKET_COUNTERS:
+	case CLOCK_SYNC:
+	case NET_SEND_STATS:
+	case HAPTIC_STATS:
+	case GYRO_BIAS:
+	case CALIBRATION_RESIDUAL:
 		return (T&)ev.vector;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+
+// microseconds on the driver's monotonic clock
+typedef unsigned long long timestamp_us_t;
+
+inline timestamp_us_t get_time_us() {
+	return (timestamp_us_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+// microseconds since the unix epoch, for anything that has to make sense to the next run
+inline unsigned long long get_wall_time_us() {
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()
+	).count();
+}
@@ -0,0 +1,72 @@
+// checks the closed form get_yaw overloads in util.h against the original
+// flatten/normalize/angle_to version, and times both. not part of the driver build:
+//
+//   g++ -O2 -std=c++14 -I.. -I<openvr>/headers yaw_bench.cpp ../basis.cpp ../quat.cpp ../vector3.cpp -o yaw_bench
+//
+// prints the largest difference (modulo 2pi) and ns per call for each pair
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "util.h"
+
+#define SAMPLES 200000
+
+// get_yaw before it was reduced to a single atan2
+static double reference_yaw(Basis basis, Vector3 front_v) {
+	Vector3 front_relative = basis.xform(front_v);
+	front_relative = (front_relative * Vector3(1, 0, 1)).normalized();
+
+	double angle = front_relative.angle_to(Vector3(0, 0, 1));
+	return -angle * Math::sign(front_relative.x);
+}
+
+static double angle_difference(double a, double b) {
+	return std::abs(wrap_angle(a - b));
+}
+
+template<typename F>
+static double ns_per_call(F f) {
+	auto start = std::chrono::steady_clock::now();
+	volatile double sink = 0.0;
+	for (int i = 0; i < SAMPLES; i++) sink = sink + f(i);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES;
+}
+
+int main() {
+	std::mt19937 rng(1234);
+	std::normal_distribution<double> normal;
+
+	// uniformly random rotations
+	std::vector<Quat> quats(SAMPLES);
+	std::vector<HmdMatrix34_t> matrices(SAMPLES);
+	for (int i = 0; i < SAMPLES; i++) {
+		quats[i] = Quat(normal(rng), normal(rng), normal(rng), normal(rng)).normalized();
+
+		Basis b = Basis(quats[i]);
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) matrices[i].m[r][c] = (float)b.elements[r][c];
+			matrices[i].m[r][3] = 0.f;
+		}
+	}
+
+	double quat_error = 0.0, matrix_error = 0.0;
+	for (int i = 0; i < SAMPLES; i++) {
+		quat_error = std::max(quat_error, angle_difference(get_yaw(quats[i]), reference_yaw(Basis(quats[i]), Vector3(0, 1, 0))));
+		matrix_error = std::max(matrix_error, angle_difference(get_yaw(matrices[i]), reference_yaw(from_hmdMatrix(matrices[i]), Vector3(0, 0, -1))));
+	}
+
+	double quat_old = ns_per_call([&](int i) { return reference_yaw(Basis(quats[i]), Vector3(0, 1, 0)); });
+	double quat_new = ns_per_call([&](int i) { return get_yaw(quats[i]); });
+	double matrix_old = ns_per_call([&](int i) { return reference_yaw(from_hmdMatrix(matrices[i]), Vector3(0, 0, -1)); });
+	double matrix_new = ns_per_call([&](int i) { return get_yaw(matrices[i]); });
+
+	printf("quat:   max difference %.3g rad, %.1f -> %.1f ns\n", quat_error, quat_old, quat_new);
+	printf("matrix: max difference %.3g rad, %.1f -> %.1f ns\n", matrix_error, matrix_old, matrix_new);
+
+	// float matrices go through the same floats both ways, anything past rounding is a bug
+	return (quat_error < 1e-9 && matrix_error < 1e-9) ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// feeds YawDriftCorrector a phone whose yaw drifted off the anchor and checks the
+// correction it hands back. not part of the driver build:
+//
+//   g++ -O2 -std=c++14 -I.. yaw_drift_test.cpp ../YawDriftCorrector.cpp -o yaw_drift_test
+//
+// exits non-zero if any case fails
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "YawDriftCorrector.h"
+
+#define FRAME_US 11111 // 90Hz
+
+#define DRIFT 0.3 // rad the phone drifted by
+
+// the hips swing around the heading while walking
+#define SWAY 0.15
+
+struct Simulation {
+	YawDriftCorrector corrector;
+	std::mt19937 rng = std::mt19937(1234);
+	timestamp_us_t now = 1000000;
+
+	// total added to the yaw offset so far
+	double correction = 0.0;
+	double max_correction = 0.0;
+
+	// seconds of walking, or standing turned away by stand_error
+	void run(double seconds, bool walking, double stand_error = 0.0) {
+		std::normal_distribution<double> sway(0.0, SWAY);
+
+		int frames = (int)(seconds * 1000000.0 / FRAME_US);
+		for (int i = 0; i < frames; i++) {
+			now += FRAME_US;
+
+			double error = DRIFT - correction + (walking ? sway(rng) : stand_error);
+			error = std::atan2(std::sin(error), std::cos(error));
+
+			correction += corrector.update(error, walking, now);
+			max_correction = std::max(max_correction, std::abs(correction));
+		}
+	}
+};
+
+static bool check(bool ok, const char* what, double value) {
+	printf("%s %s: %.4f\n", ok ? "ok  " : "FAIL", what, value);
+	return ok;
+}
+
+int main() {
+	bool ok = true;
+
+	{
+		// a short walk, then standing around turned away from the headset
+		Simulation sim;
+		sim.run(15.0, true);
+		double after_walk = sim.correction;
+		sim.run(60.0, false, 1.0);
+
+		ok &= check(std::abs(sim.correction - after_walk) < 1e-12, "standing adds nothing", sim.correction - after_walk);
+		ok &= check(sim.max_correction <= DRIFT, "short walk stays below the drift", sim.max_correction);
+	}
+
+	{
+		// long enough to catch up fully, without overshooting past the drift
+		Simulation sim;
+		sim.run(300.0, true);
+
+		ok &= check(std::abs(sim.correction - DRIFT) < 0.03, "long walk converges", sim.correction);
+		ok &= check(sim.max_correction < DRIFT + 0.03, "long walk doesn't overshoot", sim.max_correction);
+	}
+
+	{
+		// walking in bursts with long pauses ends up in the same place
+		Simulation sim;
+		for (int i = 0; i < 20; i++) {
+			sim.run(15.0, true);
+			sim.run(60.0, false, -1.0);
+		}
+
+		ok &= check(std::abs(sim.correction - DRIFT) < 0.03, "walking in bursts converges", sim.correction);
+		ok &= check(sim.max_correction < DRIFT + 0.03, "walking in bursts doesn't overshoot", sim.max_correction);
+	}
+
+	return ok ? 0 : 1;
+}
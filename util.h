@@ -21,23 +21,33 @@ inline void HmdMatrix_SetIdentity(HmdMatrix34_t* pMatrix){
 	pMatrix->m[2][3] = 0.f;
 }
 
-inline double get_yaw(Basis basis, Vector3 front_v) {
-	// xform to get front vector (up points front)
-	Vector3 front_relative = basis.xform(front_v);
-
+// into -pi..pi
+inline double wrap_angle(double a) {
+	return std::atan2(std::sin(a), std::cos(a));
+}
 
-	// flatten to XZ for yaw
-	front_relative = (front_relative * Vector3(1, 0, 1)).normalized();
+// yaw of a front vector from its X and Z alone. flattening, normalizing and taking
+// the angle to +Z all come down to this, the length doesn't matter to atan2
+inline double yaw_from_front(double front_x, double front_z) {
+	return -std::atan2(front_x, front_z);
+}
 
-	// get angle
-	double angle = front_relative.angle_to(Vector3(0, 0, 1));
+inline double get_yaw(const Basis& basis, const Vector3& front_v) {
+	// only the X and Z rows of the xform are needed
+	return yaw_from_front(basis.elements[0].dot(front_v), basis.elements[2].dot(front_v));
+}
 
-	// convert to offset (idk why front_relative.x works)
-	return -angle * Math::sign(front_relative.x);
+// same as get_yaw(Basis(quat), Vector3(0, 1, 0)), that's the quat's rotated Y axis
+inline double get_yaw(const Quat& quat) {
+	return yaw_from_front(
+		quat.x * quat.y - quat.w * quat.z,
+		quat.y * quat.z + quat.w * quat.x
+	);
 }
 
-inline double get_yaw(Quat quat) {
-	return get_yaw(Basis(quat), Vector3(0, 1, 0));
+// same as get_yaw(from_hmdMatrix(matrix), Vector3(0, 0, -1)), a device's forward
+inline double get_yaw(const HmdMatrix34_t& matrix) {
+	return yaw_from_front(-matrix.m[0][2], -matrix.m[2][2]);
 }
 
 inline Basis from_hmdMatrix(const HmdMatrix34_t &matrix) {
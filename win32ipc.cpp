@@ -10,7 +10,7 @@ Win32IPC::Win32IPC(bool is_server, std::string pipe_name) {
 }
 
 void Win32IPC::init() {
-	LOG_FUNC("IPC init");
+	DRIVER_LOG("IPC init");
 	init_mailslot();
 }
 
@@ -47,7 +47,7 @@ IPCData Win32IPC::get_data() {
 
 void Win32IPC::put_data(IPCData data) {
 	if (server_mode) {
-		LOG_FUNC("Cannot put data from server!");
+		DRIVER_LOG("Cannot put data from server!");
 		return;
 	}
 	// probably shouldnt silently fail
@@ -56,21 +56,21 @@ void Win32IPC::put_data(IPCData data) {
 	DWORD b_written;
 	bool success = WriteFile(hSlot, data.buffer, data.data_length, &b_written, NULL);
 	if (!success) {
-		LOG_FUNC("IPC Write failed");
-		if (GetLastError() == 38) {
+		DWORD err = GetLastError();
+		if (err == 38) {
 			// procss restarted? retry
+			DRIVER_LOG("IPC Write failed (%lu), reopening", err);
 			init_mailslot();
 			return put_data(data);
 		}
-		LOG_FUNC(std::to_string(GetLastError()).c_str());
+		DRIVER_LOG("IPC Write failed (%lu)", err);
 		return;
 	}
 }
 
 bool Win32IPC::read_slot(int max_num_msgs) {
 	if (!server_mode) {
-		LOG_FUNC("Cannot read data from client!");
-		LOG_FUNC(name.c_str());
+		DRIVER_LOG("Cannot read data from client! %s", name.c_str());
 		return false;
 	}
 	if (hSlot == INVALID_HANDLE_VALUE) return false;
@@ -86,7 +86,7 @@ bool Win32IPC::read_slot(int max_num_msgs) {
 	);
 
 	if (!result) {
-		LOG_FUNC("GetMailSlot failed");
+		DRIVER_LOG("GetMailSlot failed (%lu)", GetLastError());
 		return false;
 	}
 
@@ -112,8 +112,7 @@ bool Win32IPC::read_slot(int max_num_msgs) {
 		result = ReadFile(hSlot, buff, BUFFSIZE, &b_read, &ov);
 
 		if (!result) {
-			LOG_FUNC("IPC Read failed");
-			LOG_FUNC(std::to_string(GetLastError()).c_str());
+			DRIVER_LOG("IPC Read failed (%lu)", GetLastError());
 			return false;
 		}
 
@@ -126,7 +125,7 @@ bool Win32IPC::read_slot(int max_num_msgs) {
 			NULL
 		);
 		if (!result) {
-			LOG_FUNC("GetMailSlot failed");
+			DRIVER_LOG("GetMailSlot failed (%lu)", GetLastError());
 			return false;
 		}
 
@@ -147,7 +146,7 @@ bool Win32IPC::init_mailslot() {
 		);
 
 		if (hSlot == INVALID_HANDLE_VALUE) {
-			LOG_FUNC("IPC CreateMailslotA failed!!!");
+			DRIVER_LOG("IPC CreateMailslotA failed!!! (%lu)", GetLastError());
 			return false;
 		}
 	}
@@ -163,15 +162,14 @@ bool Win32IPC::init_mailslot() {
 		);
 
 		if (hSlot == INVALID_HANDLE_VALUE) {
-			if (GetLastError() == 2) { // file not found, probably one of the apps hasnt yet loaded
+			DWORD err = GetLastError();
+			if (err == 2) { // file not found, probably one of the apps hasnt yet loaded
 				std::thread* delay = new std::thread([&] {
 					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 					init_mailslot();
 				});
 			}
-			LOG_FUNC("IPC CreateFile failed!!!");
-			LOG_FUNC(name.c_str());
-			LOG_FUNC(std::to_string(GetLastError()).c_str());
+			DRIVER_LOG("IPC CreateFile failed!!! %s (%lu)", name.c_str(), err);
 			return false;
 		}
 	}